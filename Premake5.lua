@@ -12,10 +12,10 @@ local rootDir = path.getabsolute(_WORKING_DIR)
 -- Log what the startup project will be
 premake.info("Working DIR: " .. _WORKING_DIR)
 
-premake.info("Search DIR: " .. rootDir .. "\\projects\\*")
+premake.info("Search DIR: " .. rootDir .. "/projects/*")
 
 -- Get all the directories in our projects directory
-local projects = os.matchdirs(rootDir .. "\\projects\\*")
+local projects = os.matchdirs(rootDir .. "/projects/*")
 
 if (projects[#projects]) then
 	-- Select the last item in the project directory to be our startup project 
@@ -28,6 +28,38 @@ end
 -- Log what the startup project will be
 premake.info("Startup project: " .. startup)
 
+-- Pass --trace to compile in the trace.json instrumentation (see external/toolkit/Trace.h)
+newoption {
+	trigger = "trace",
+	description = "Record hot path spans and dump them to trace.json for chrome://tracing or Perfetto"
+}
+
+-- Pass --headless to generate only the sim and its command line runner, with no GL, GLFW or windowing dependencies
+-- (for build and profiling machines without a display or GL headers)
+newoption {
+	trigger = "headless",
+	description = "Only generate the Headless project, which needs no GL, GLFW or X11"
+}
+
+-- Pass --osmesa to build GLFW on its null platform with OSMesa contexts (Linux only), so the game and benchmarks need
+-- no X11 or display at all. Only useful with --offscreen, there is never a window to see
+newoption {
+	trigger = "osmesa",
+	description = "Build GLFW without X11, rendering through OSMesa (for --offscreen on machines with no display)"
+}
+
+-- Pass --sanitize=<name> to build everything with one of gcc/clang's sanitizers (Linux only)
+newoption {
+	trigger = "sanitize",
+	value = "SANITIZER",
+	description = "Build with a sanitizer on Linux",
+	allowed = {
+		{ "address", "AddressSanitizer and LeakSanitizer" },
+		{ "undefined", "UndefinedBehaviorSanitizer" },
+		{ "thread", "ThreadSanitizer" }
+	}
+}
+
 -- This is our solution name
 workspace "SnakeCG"
 	-- Processor architecture
@@ -42,6 +74,32 @@ workspace "SnakeCG"
 		"Release"
 	}
 
+	-- Applies to every project, so the toolkit and the game agree on whether tracing exists
+	filter "options:trace"
+		defines {
+			"ENABLE_TRACING"
+		}
+
+	-- Keep frame pointers so perf can walk the stack, and export our symbols so stack traces have names in them
+	filter "system:linux"
+		buildoptions {
+			"-fno-omit-frame-pointer"
+		}
+		linkoptions {
+			"-rdynamic"
+		}
+
+	if _OPTIONS["sanitize"] then
+		filter "system:linux"
+			buildoptions {
+				"-fsanitize=" .. _OPTIONS["sanitize"]
+			}
+			linkoptions {
+				"-fsanitize=" .. _OPTIONS["sanitize"]
+			}
+	end
+	filter {}
+
 -- The directory name for our output
 outputdir = "%{cfg.buildcfg}-%{cfg.system}-%{cfg.architecture}"
 
@@ -58,12 +116,106 @@ IncludeDir["toolkit"] = "external/toolkit"
 IncludeDir["entt"]    = "external/entt"
 IncludeDir["cereal"]    = "external/cereal"
 
+-- The sim with no window, built from the startup project's GL free sources. Runs random games across every core, or
+-- fast forwards through replays (see headless/src/main.cpp)
+if (startup ~= "") then
+	-- Relative path to the game the sim is taken from
+	local gamedir = "projects/" .. startup
+
+	premake.info("Adding project: Headless")
+
+	project "Headless"
+		location "headless"
+		kind "ConsoleApp"
+		language "C++"
+		cppdialect "C++17"
+		staticruntime "on"
+
+		targetdir ("%{wks.location}/bin/" .. outputdir .. "/%{prj.name}")
+		objdir ("%{wks.location}/obj/" .. outputdir .. "/%{prj.name}")
+
+		debugdir ("%{wks.location}bin/%{outputdir}/%{prj.name}")
+
+		-- Nothing in here may include GL or GLFW, the toolkit's logging and tracing are built in directly rather than
+		-- linking the whole toolkit
+		files {
+			"%{prj.location}/src/**.h",
+			"%{prj.location}/src/**.cpp",
+			gamedir .. "/src/AllocCounter.*",
+			gamedir .. "/src/Checkpointer.*",
+			gamedir .. "/src/FixedTimestep.*",
+			gamedir .. "/src/FreeCellSet.*",
+			gamedir .. "/src/Grid.*",
+			gamedir .. "/src/Headless.*",
+			gamedir .. "/src/Random.h",
+			gamedir .. "/src/Replay.*",
+			gamedir .. "/src/RingBuffer.h",
+			gamedir .. "/src/SimRunner.*",
+			gamedir .. "/src/SnakeBatch.*",
+			gamedir .. "/src/SnakeRules.h",
+			gamedir .. "/src/SnakeSim.*",
+			gamedir .. "/src/Snapshot.*",
+			"external/toolkit/Logging.*",
+			"external/toolkit/Trace.*",
+			"external/toolkit/CerealGLM.h"
+		}
+
+		defines {
+			"_CRT_SECURE_NO_WARNINGS"
+		}
+
+		includedirs {
+			"%{prj.location}/src",
+			gamedir .. "/src",
+			"%{IncludeDir.cereal}",
+			"%{IncludeDir.spdlog}",
+			"%{IncludeDir.glm}",
+			"%{IncludeDir.toolkit}"
+		}
+
+		filter "system:windows"
+			systemversion "latest"
+
+			defines {
+				"WINDOWS"
+			}
+
+			links {
+				"imagehlp.lib"
+			}
+
+		filter "system:linux"
+			links {
+				"pthread"
+			}
+
+		filter "configurations:Debug"
+			runtime "Debug"
+			symbols "on"
+
+			defines {
+				"TRACK_ALLOCATIONS"
+			}
+
+		filter "configurations:Release"
+			runtime "Release"
+			optimize "on"
+			-- Symbols for perf and valgrind
+			symbols "on"
+	filter {}
+end
+
+-- Everything below needs GL and a window
+if _OPTIONS["headless"] then
+	return
+end
+
 -- These are other projects that we want to include in our solution (each needs their own premake)
 include "external/glfw3"
 include "external/glad"
 include "external/imgui"
 include "external/stbs"
-include "external/Toolkit"
+include "external/toolkit"
 
 -- Iterate over all the projects (k is the index)
 for k, proj in pairs(projects) do
@@ -91,43 +243,35 @@ for k, proj in pairs(projects) do
 		staticruntime "on"
 
 		-- This is where we will output our compiled program
-		targetdir ("%{wks.location}\\bin\\" .. outputdir .. "\\%{prj.name}")
+		targetdir ("%{wks.location}/bin/" .. outputdir .. "/%{prj.name}")
 		-- This is where we will output our intermediate files
-		objdir ("%{wks.location}\\obj\\" .. outputdir .. "\\%{prj.name}")
+		objdir ("%{wks.location}/obj/" .. outputdir .. "/%{prj.name}")
 
 		-- Set the debug working directory to the output directory
-		debugdir ("%{wks.location}bin\\%{outputdir}\\%{prj.name}")
+		debugdir ("%{wks.location}bin/%{outputdir}/%{prj.name}")
 
-		-- Gets the absolute directory of the current project
+		-- Gets the absolute directory of the current project (for xcopy, so it keeps its backslashes)
 		absdir = "%{wks.location}bin\\%{outputdir}\\%{prj.name}"
 
 		-- Gets our project's resource file location
 		resdir = "%{prj.location}res"
 
-		-- These are the commands that get executed after build, but before debugging
-		postbuildcommands {
-			-- This step copies over anything in the dll folder to the output directory
-	  		"(xcopy /Q /E /Y /I /C \"%{wks.location}external\\dll\" \"%{absdir}\")",
-	  		-- This step ensures that the project has a resource directory
-	  		"(IF NOT EXIST \"%{resdir}\" mkdir \"%{resdir}\")",
-	  		-- This step copies all the resources to the output directory
-	  		"(xcopy /Q /E /Y /I /C \"%{resdir}\" \"%{absdir}\")"
-		} 
-
 		-- Our source files are everything in the src folder
 		files {
-			"%{prj.location}\\src\\**.h",
-			"%{prj.location}\\src\\**.cpp"
+			"%{prj.location}/src/**.h",
+			"%{prj.location}/src/**.cpp"
 		}
 
-		-- Disable CRT secure warnings
+		-- Disable CRT secure warnings, and tell shader hot reloading where the original resources are (the ones in the
+		-- target dir are copies that get overwritten on every build)
 		defines {
-			"_CRT_SECURE_NO_WARNINGS"
+			"_CRT_SECURE_NO_WARNINGS",
+			'RES_DIR="' .. rootDir .. "/" .. relpath .. '/res"'
 		}
 
 		-- Defines what directories we want to include
 		includedirs {
-			"%{prj.location}\\src",
+			"%{prj.location}/src",
 			"%{IncludeDir.entt}",
 			"%{IncludeDir.cereal}",
 			"%{IncludeDir.fmod}",	
@@ -146,10 +290,7 @@ for k, proj in pairs(projects) do
 			"Glad",
 			"stbs",
 			"ImGui",
-			"Toolkit",
-			"opengl32.lib",
-			"imagehlp.lib",
-			"external/fmod/fmod64.lib"
+			"Toolkit"
 		}
 
 		-- This filters for our windows builds
@@ -162,13 +303,171 @@ for k, proj in pairs(projects) do
 				"WINDOWS"
 			}
 
+			links {
+				"opengl32.lib",
+				"imagehlp.lib",
+				"external/fmod/fmod64.lib"
+			}
+
+			-- These are the commands that get executed after build, but before debugging
+			postbuildcommands {
+				-- This step copies over anything in the dll folder to the output directory
+		  		"(xcopy /Q /E /Y /I /C \"%{wks.location}external\\dll\" \"%{absdir}\")",
+		  		-- This step ensures that the project has a resource directory
+		  		"(IF NOT EXIST \"%{resdir}\" mkdir \"%{resdir}\")",
+		  		-- This step copies all the resources to the output directory
+		  		"(xcopy /Q /E /Y /I /C \"%{resdir}\" \"%{absdir}\")"
+			}
+
+		-- And these for our linux builds (GLFW is built for X11, unless --osmesa). There are no dlls to copy, fmod isn't used on Linux
+		filter "system:linux"
+			defines {
+				"GLFW_INCLUDE_NONE"
+			}
+
+			links {
+				"dl",
+				"pthread"
+			}
+
+			-- GLFW's null platform loads OSMesa itself when the window is made, so there is no GL or X11 to link
+			if not _OPTIONS["osmesa"] then
+				links {
+					"GL",
+					"X11"
+				}
+			end
+
+			postbuildcommands {
+				"mkdir -p \"%{resdir}\"",
+				"cp -rf \"%{resdir}/.\" \"%{cfg.targetdir}\""
+			}
+
 		-- Filters for our debug configurations
 		filter "configurations:Debug"
 			runtime "Debug"
 			symbols "on"
 
+			-- Count heap allocations, so we get warned when a hot path starts allocating
+			defines {
+				"TRACK_ALLOCATIONS"
+			}
+
 		-- Filters for release configuration
 		filter "configurations:Release"
 			runtime "Release"
 			optimize "on"
-end
\ No newline at end of file
+end
+-- The microbenchmarks build the startup project's game code (minus its main) together with benchmarks/src, so they
+-- always measure the code that ships. Run them from the Release build, they take --filter <text> and --min-seconds <s>
+if (startup ~= "") then
+	-- Relative path to the game the benchmarks are built against
+	local gamedir = "projects/" .. startup
+
+	premake.info("Adding project: Benchmarks")
+
+	project "Benchmarks"
+		location "benchmarks"
+		kind "ConsoleApp"
+		language "C++"
+		cppdialect "C++17"
+		staticruntime "on"
+
+		targetdir ("%{wks.location}/bin/" .. outputdir .. "/%{prj.name}")
+		objdir ("%{wks.location}/obj/" .. outputdir .. "/%{prj.name}")
+
+		debugdir ("%{wks.location}bin/%{outputdir}/%{prj.name}")
+
+		-- The rendering benchmarks load the game's shaders
+		local gameres = "%{wks.location}" .. gamedir .. "/res"
+
+		files {
+			"%{prj.location}/src/**.h",
+			"%{prj.location}/src/**.cpp",
+			gamedir .. "/src/**.h",
+			gamedir .. "/src/**.cpp"
+		}
+
+		-- The game's entry point, the benchmarks have their own
+		removefiles {
+			gamedir .. "/src/main.cpp"
+		}
+
+		-- Allocations are always counted here, allocs/op is half the point
+		defines {
+			"_CRT_SECURE_NO_WARNINGS",
+			"TRACK_ALLOCATIONS"
+		}
+
+		includedirs {
+			"%{prj.location}/src",
+			gamedir .. "/src",
+			"%{IncludeDir.entt}",
+			"%{IncludeDir.cereal}",
+			"%{IncludeDir.fmod}",
+			"%{IncludeDir.spdlog}",
+			"%{IncludeDir.glfw}",
+			"%{IncludeDir.glad}",
+			"%{IncludeDir.ImGui}",
+			"%{IncludeDir.glm}",
+			"%{IncludeDir.stbs}",
+			"%{IncludeDir.toolkit}"
+		}
+
+		links {
+			"GLFW",
+			"Glad",
+			"stbs",
+			"ImGui",
+			"Toolkit"
+		}
+
+		filter "system:windows"
+			systemversion "latest"
+
+			defines {
+				"GLFW_INCLUDE_NONE",
+				"WINDOWS"
+			}
+
+			links {
+				"opengl32.lib",
+				"imagehlp.lib",
+				"external/fmod/fmod64.lib"
+			}
+
+			postbuildcommands {
+		  		"(xcopy /Q /E /Y /I /C \"%{wks.location}external\\dll\" \"%{cfg.targetdir}\")",
+		  		"(xcopy /Q /E /Y /I /C \"" .. path.translate(gameres, "\\") .. "\" \"%{cfg.targetdir}\")"
+			}
+
+		filter "system:linux"
+			defines {
+				"GLFW_INCLUDE_NONE"
+			}
+
+			links {
+				"dl",
+				"pthread"
+			}
+
+			-- GLFW's null platform loads OSMesa itself when the window is made, so there is no GL or X11 to link
+			if not _OPTIONS["osmesa"] then
+				links {
+					"GL",
+					"X11"
+				}
+			end
+
+			postbuildcommands {
+				"cp -rf \"" .. gameres .. "/.\" \"%{cfg.targetdir}\""
+			}
+
+		filter "configurations:Debug"
+			runtime "Debug"
+			symbols "on"
+
+		filter "configurations:Release"
+			runtime "Release"
+			optimize "on"
+end
@@ -0,0 +1,39 @@
+#include "Benchmark.h"
+#include "AllocCounter.h"
+
+#include <cstdio>
+
+std::string Benchmark::myFilter;
+double Benchmark::myMinSeconds = 0.5;
+volatile uint64_t Benchmark::mySink = 0;
+
+void Stopwatch::Start() {
+	myStartAllocations = AllocCounter::GetThreadCount();
+	myStart = std::chrono::steady_clock::now();
+}
+
+void Stopwatch::Stop() {
+	auto end = std::chrono::steady_clock::now();
+	myAllocations += AllocCounter::GetThreadCount() - myStartAllocations;
+	mySeconds += std::chrono::duration<double>(end - myStart).count();
+}
+
+void Benchmark::Run(const std::string& name, const Batch& batch) {
+	if (!myFilter.empty() && name.find(myFilter) == std::string::npos) {
+		return;
+	}
+
+	// one batch to warm up caches and let any lazily allocated storage settle, it isn't counted
+	Stopwatch warmup;
+	batch(warmup);
+
+	Stopwatch stopwatch;
+	uint64_t ops = 0;
+	while (stopwatch.GetSeconds() < myMinSeconds) {
+		ops += batch(stopwatch);
+	}
+
+	printf("%-52s %12.1f ns/op %10.3f allocs/op %12llu ops\n", name.c_str(),
+		stopwatch.GetSeconds() * 1e9 / ops, (double)stopwatch.GetAllocations() / ops, (unsigned long long)ops);
+	fflush(stdout);
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+// Measures the interesting part of a benchmark. Only the time and heap allocations between Start and Stop are counted,
+// so anything a benchmark has to set up (or reset) between batches can happen outside of it
+class Stopwatch {
+public:
+	void Start();
+	void Stop();
+
+	double GetSeconds() const { return mySeconds; }
+	uint64_t GetAllocations() const { return myAllocations; }
+
+private:
+	std::chrono::steady_clock::time_point myStart;
+	uint64_t myStartAllocations = 0;
+	double mySeconds = 0.0;
+	uint64_t myAllocations = 0;
+};
+
+class Benchmark {
+public:
+	// Runs one batch of a benchmark. It should time its work with the stopwatch and return how many operations it timed
+	typedef std::function<uint64_t(Stopwatch& stopwatch)> Batch;
+
+	// Runs batches until at least the minimum time has been measured, then prints ns/op and allocations/op. Skipped if
+	// the name doesn't contain the filter
+	static void Run(const std::string& name, const Batch& batch);
+
+	static void SetFilter(const std::string& filter) { myFilter = filter; } // only run benchmarks containing this
+	static void SetMinSeconds(double seconds) { myMinSeconds = seconds; } // measured time per benchmark, 0.5s by default
+
+	// Keeps the compiler from optimising away a result that is otherwise unused
+	static void Consume(uint64_t value) { mySink = mySink + value; }
+
+private:
+	static std::string myFilter;
+	static double myMinSeconds;
+	static volatile uint64_t mySink;
+};
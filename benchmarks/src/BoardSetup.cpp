@@ -0,0 +1,49 @@
+#include "BoardSetup.h"
+#include "Grid.h"
+#include "Random.h"
+
+namespace {
+	int wrapIndex(int index, int size) {
+		int cells = size * size;
+		return ((index % cells) + cells) % cells;
+	}
+}
+
+glm::ivec2 CycleCell(int index, int size) {
+	index = wrapIndex(index, size);
+	int y = index / size;
+	int x = ((index % size) - y + size) % size;
+	return glm::ivec2(x, y);
+}
+
+int CycleInput(int index, int size) {
+	index = wrapIndex(index, size);
+	// the last cell of a row steps up, everything else steps right
+	return (index + 1) % size == 0 ? 0 : 3;
+}
+
+SimSnapshot MakeSnakeSnapshot(int length, int size) {
+	SimSnapshot snapshot;
+	snapshot.width = size;
+	snapshot.height = size;
+
+	// lay everything out on a grid, so the empty cell index comes out the same as the sim would have it
+	Grid grid(size, size);
+	for (int i = 0; i < length; i++) {
+		glm::ivec2 cell = CycleCell(length - 1 - i, size);
+		snapshot.snek.push_back(cell);
+		grid.set(cell, CellType::Snake);
+	}
+
+	snapshot.scalars.fruit = CycleCell(-1, size);
+	if (length < size * size) {
+		grid.set(snapshot.scalars.fruit, CellType::Fruit);
+	}
+
+	grid.saveFreeOrder(snapshot.orderSlots, snapshot.orderCells);
+	snapshot.emptyCount = grid.getEmptyCount();
+
+	snapshot.scalars.rngState = Random(1).state;
+	snapshot.scalars.direction = CycleInput(length - 2, size);
+	return snapshot;
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <GLM/glm.hpp>
+
+#include "SnakeSim.h"
+#include "Snapshot.h"
+
+// Ways of putting the sim into a known state for benchmarking, without having to play it there. Boards are square,
+// size x size cells
+
+// A loop through every cell of the board. Each row is walked to the right, and the end of a row steps up onto the next
+// row one column left of where the previous row started. With the board wrapping around that closes up, so a snake
+// following the loop never runs into itself, however long it is
+glm::ivec2 CycleCell(int index, int size = SnakeSim::DEFAULT_SIZE);
+// The input that moves a snake whose head is on CycleCell(index) onto CycleCell(index + 1)
+int CycleInput(int index, int size = SnakeSim::DEFAULT_SIZE);
+
+// A sim state with a snake of the given length lying along the loop, head first at CycleCell(length - 1), and the fruit
+// right behind its tail (so the head won't reach it for a long time). length can be anything up to the whole board
+SimSnapshot MakeSnakeSnapshot(int length, int size = SnakeSim::DEFAULT_SIZE);
@@ -0,0 +1,67 @@
+#include "Benchmark.h"
+#include "BoardSetup.h"
+#include "QuadRenderer.h"
+#include "Shader.h"
+#include "SnakeSim.h"
+#include "SnakeWorld.h"
+
+#include "TTK/TTKContext.h"
+
+#include <string>
+
+namespace {
+	constexpr int SIZE = SnakeSim::DEFAULT_SIZE;
+	constexpr int LINES_PER_BATCH = 500;
+}
+
+// Needs a current GL context with glad loaded
+void RunRenderBenchmarks() {
+	Shader_sptr shader = std::make_shared<Shader>();
+	shader->Load("passthrough_instanced.vs", "passthrough.fs");
+	QuadRenderer renderer;
+
+	for (int length : { 10, 100, 1000, SIZE * SIZE }) {
+		std::string name = length == SIZE * SIZE ? "full board" : "length " + std::to_string(length);
+
+		SnakeSim sim;
+		sim.restoreSnapshot(MakeSnakeSnapshot(length));
+		SnakeWorld world;
+		world.rebuild(sim);
+
+		// turning the entities into instance records, which is what updating every object's mesh used to be
+		Benchmark::Run("Instance batch build, " + name, [&](Stopwatch& stopwatch) {
+			stopwatch.Start();
+			renderer.Begin();
+			world.buildBatch(renderer, 0.5f);
+			stopwatch.Stop();
+			return (uint64_t)1;
+		});
+
+		// building, uploading and drawing the batch. glFinish makes sure the GPU's side of it is part of the time
+		Benchmark::Run("Instance batch build + upload + draw, " + name, [&](Stopwatch& stopwatch) {
+			stopwatch.Start();
+			renderer.Begin();
+			world.buildBatch(renderer, 0.5f);
+			shader->Bind();
+			renderer.Flush();
+			glFinish();
+			stopwatch.Stop();
+			return (uint64_t)1;
+		});
+	}
+
+	// the toolkit's immediate mode lines, which flush on their own whenever the vertex array fills up
+	TTK::Context& context = TTK::Context::Instance();
+	Benchmark::Run("TTK AddLine + Flush, " + std::to_string(LINES_PER_BATCH) + " lines", [&](Stopwatch& stopwatch) {
+		stopwatch.Start();
+		for (int i = 0; i < LINES_PER_BATCH; i++) {
+			float x = (float)i / LINES_PER_BATCH;
+			context.AddLine(glm::vec3(x, 0.0f, 0.0f), glm::vec3(x, 1.0f, 0.0f), glm::vec4(1.0f));
+		}
+		context.Flush();
+		glFinish();
+		stopwatch.Stop();
+		return (uint64_t)LINES_PER_BATCH;
+	});
+	TTK::Context::DestroyContext();
+}
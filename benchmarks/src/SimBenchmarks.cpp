@@ -0,0 +1,201 @@
+#include "AllocCounter.h"
+#include "Benchmark.h"
+#include "BoardSetup.h"
+#include "Checkpointer.h"
+#include "Grid.h"
+#include "Random.h"
+#include "SnakeBatch.h"
+#include "SnakeSim.h"
+#include "SnakeWorld.h"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace {
+	constexpr int SIZE = SnakeSim::DEFAULT_SIZE;
+	// ticks per batch. Short enough that no obstacle spawns (every 100 ticks) and the head never reaches the fruit
+	constexpr int TICKS_PER_BATCH = 50;
+
+	// a snake of each length on the default board, and then ones on boards far bigger than it that should cost the
+	// same per tick, since nothing in the sim is meant to scale with the area of the board
+	struct SnakeCase {
+		int length;
+		int size;
+	};
+	const SnakeCase SNAKE_CASES[] = {
+		{ 10, SIZE }, { 100, SIZE }, { 1000, SIZE }, { SIZE * SIZE, SIZE },
+		{ 1000, 256 }, { 1000, 4096 }
+	};
+
+	std::string CaseName(const SnakeCase& snake) {
+		std::string name = snake.length == snake.size * snake.size ? "full board" : "length " + std::to_string(snake.length);
+		if (snake.size != SIZE) {
+			name += ", " + std::to_string(snake.size) + "x" + std::to_string(snake.size);
+		}
+		return name;
+	}
+}
+
+bool CheckTickAllocations() {
+	if (!AllocCounter::IsEnabled()) {
+		return true;
+	}
+
+	// a board that fits in the storage the sim reserves up front shouldn't touch the heap from its very first tick,
+	// including every death, win and board size change along the way
+	bool passed = true;
+	for (int size : { 2, SIZE, 64 }) {
+		SnakeSim sim(1, SIZE, SIZE);
+		sim.reset(2, size, size);
+		Random rng(5);
+
+		AllocCounter::Scope allocs;
+		for (int t = 0; t < 20000; t++) {
+			sim.step((int)rng.below(5) - 1);
+		}
+		if (allocs.GetCount() > 0) {
+			printf("FAILED: ticks on a %dx%d board made %llu heap allocations\n", size, size, (unsigned long long)allocs.GetCount());
+			passed = false;
+		}
+	}
+	return passed;
+}
+
+void RunSimBenchmarks() {
+	// is the cell the head is moving into taken? This is the whole collision check now
+	Benchmark::Run("Collision lookup (grid)", [](Stopwatch& stopwatch) {
+		static SnakeSim sim;
+		static std::vector<glm::ivec2> cells;
+		if (cells.empty()) {
+			sim.restoreSnapshot(MakeSnakeSnapshot(1000));
+			Random rng(7);
+			for (int i = 0; i < 4096; i++) {
+				cells.emplace_back(rng.below(SIZE), rng.below(SIZE));
+			}
+		}
+
+		const Grid& grid = sim.getGrid();
+		uint64_t hits = 0;
+		stopwatch.Start();
+		for (glm::ivec2 cell : cells) {
+			hits += grid.get(cell) != CellType::Empty;
+		}
+		stopwatch.Stop();
+		Benchmark::Consume(hits);
+		return (uint64_t)cells.size();
+	});
+
+	// what SnakeSim::newFruitPos does (pick a random empty cell and fill it), plus emptying it again so the board
+	// stays at the same occupancy
+	for (int percent : { 0, 50, 90, 99 }) {
+		Grid grid(SIZE, SIZE);
+		Random rng(3);
+		int toFill = SIZE * SIZE * percent / 100;
+		for (int i = 0; i < toFill; i++) {
+			grid.set(grid.getEmptyCell(rng.below(grid.getEmptyCount())), CellType::Obstacle);
+		}
+
+		Benchmark::Run("Fruit spawn, " + std::to_string(percent) + "% full", [&](Stopwatch& stopwatch) {
+			stopwatch.Start();
+			for (int i = 0; i < 1000; i++) {
+				glm::ivec2 cell = grid.getEmptyCell(rng.below(grid.getEmptyCount()));
+				grid.set(cell, CellType::Fruit);
+				grid.set(cell, CellType::Empty);
+			}
+			stopwatch.Stop();
+			return (uint64_t)1000;
+		});
+	}
+
+	for (const SnakeCase& snake : SNAKE_CASES) {
+		int length = snake.length, size = snake.size;
+		SimSnapshot snapshot = MakeSnakeSnapshot(length, size);
+		SnakeSim sim(0, size, size);
+		SnakeWorld world;
+
+		Benchmark::Run("Sim step, " + CaseName(snake), [&](Stopwatch& stopwatch) {
+			sim.restoreSnapshot(snapshot);
+			stopwatch.Start();
+			for (int t = 0; t < TICKS_PER_BATCH; t++) {
+				sim.step(CycleInput(length - 1 + t, size));
+			}
+			stopwatch.Stop();
+			return (uint64_t)TICKS_PER_BATCH;
+		});
+
+		// one tick of Game::Update: the sim step, and bringing the entities in line with it
+		Benchmark::Run("Tick (step + world sync), " + CaseName(snake), [&](Stopwatch& stopwatch) {
+			sim.restoreSnapshot(snapshot);
+			world.rebuild(sim);
+			stopwatch.Start();
+			for (int t = 0; t < TICKS_PER_BATCH; t++) {
+				StepResult result = sim.step(CycleInput(length - 1 + t, size));
+				world.onStep(sim, result);
+			}
+			stopwatch.Stop();
+			return (uint64_t)TICKS_PER_BATCH;
+		});
+
+		// a checkpoint a second apart, which the game takes every 10 ticks
+		Checkpointer checkpoints(30, 600);
+		Benchmark::Run("Checkpoint capture, " + CaseName(snake), [&](Stopwatch& stopwatch) {
+			sim.restoreSnapshot(snapshot);
+			for (int t = 0; t < TICKS_PER_BATCH; t += 10) {
+				for (int i = 0; i < 10; i++) {
+					sim.step(CycleInput(length - 1 + t + i, size));
+				}
+				stopwatch.Start();
+				checkpoints.capture(sim, t);
+				stopwatch.Stop();
+			}
+			return (uint64_t)(TICKS_PER_BATCH / 10);
+		});
+
+		// starting over after a death, which only has to undo the cells the game touched
+		Benchmark::Run("Reset, " + CaseName(snake), [&](Stopwatch& stopwatch) {
+			sim.restoreSnapshot(snapshot);
+			stopwatch.Start();
+			sim.resetGame();
+			stopwatch.Stop();
+			return (uint64_t)1;
+		});
+	}
+
+	// the batched simulator bots train on, per game per tick, next to the same games stepped one SnakeSim at a time.
+	// Both play the same random actions from fresh games, so the snakes stay short and die now and then
+	for (uint32_t games : { 64u, 1024u }) {
+		std::vector<int8_t> actions((size_t)games * TICKS_PER_BATCH);
+		Random rng(9);
+		for (int8_t& action : actions) {
+			action = (int8_t)((int)rng.below(5) - 1);
+		}
+
+		SnakeBatch batch(games, 1);
+		Benchmark::Run("Batch step, " + std::to_string(games) + " games", [&](Stopwatch& stopwatch) {
+			stopwatch.Start();
+			for (int t = 0; t < TICKS_PER_BATCH; t++) {
+				batch.stepAll(&actions[(size_t)t * games]);
+			}
+			stopwatch.Stop();
+			return (uint64_t)games * TICKS_PER_BATCH;
+		});
+
+		std::vector<SnakeSim> sims;
+		sims.reserve(games);
+		for (uint32_t game = 0; game < games; game++) {
+			sims.emplace_back(1 + game);
+		}
+		Benchmark::Run("Sim step, " + std::to_string(games) + " games one at a time", [&](Stopwatch& stopwatch) {
+			stopwatch.Start();
+			for (int t = 0; t < TICKS_PER_BATCH; t++) {
+				const int8_t* tickActions = &actions[(size_t)t * games];
+				for (uint32_t game = 0; game < games; game++) {
+					sims[game].step(tickActions[game]);
+				}
+			}
+			stopwatch.Stop();
+			return (uint64_t)games * TICKS_PER_BATCH;
+		});
+	}
+}
@@ -0,0 +1,68 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include "Benchmark.h"
+#include "Logging.h"
+
+#include <cstdio>
+#include <stdlib.h>
+#include <string.h>
+
+bool CheckTickAllocations();
+void RunSimBenchmarks();
+void RunRenderBenchmarks();
+
+// Opens a hidden window to get a GL context for the rendering benchmarks. Returns null if there is no GL to be had
+GLFWwindow* CreateHiddenWindow() {
+	if (glfwInit() == GLFW_FALSE) {
+		return nullptr;
+	}
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	GLFWwindow* window = glfwCreateWindow(800, 800, "Benchmarks", nullptr, nullptr);
+	if (window == nullptr) {
+		glfwTerminate();
+		return nullptr;
+	}
+	glfwMakeContextCurrent(window);
+	if (gladLoadGLLoader((GLADloadproc)glfwGetProcAddress) == 0) {
+		glfwDestroyWindow(window);
+		glfwTerminate();
+		return nullptr;
+	}
+	// the game runs with vsync, but here it would only throttle the draw benchmarks
+	glfwSwapInterval(0);
+	return window;
+}
+
+int main(int argc, char** argv) {
+	Logger::Init();
+
+	for (int i = 1; i + 1 < argc; i++) {
+		// --filter <text> only runs the benchmarks with that text in their name
+		if (strcmp(argv[i], "--filter") == 0) {
+			Benchmark::SetFilter(argv[i + 1]);
+		}
+		// --min-seconds <seconds> sets how long each benchmark is measured for
+		else if (strcmp(argv[i], "--min-seconds") == 0) {
+			Benchmark::SetMinSeconds(strtod(argv[i + 1], nullptr));
+		}
+	}
+
+	// the benchmarks still run if this fails, so the numbers show where the allocations are
+	bool passed = CheckTickAllocations();
+	RunSimBenchmarks();
+
+	GLFWwindow* window = CreateHiddenWindow();
+	if (window != nullptr) {
+		LOG_INFO(glGetString(GL_RENDERER));
+		RunRenderBenchmarks();
+		glfwDestroyWindow(window);
+		glfwTerminate();
+	}
+	else {
+		printf("No OpenGL context available, skipping the rendering benchmarks\n");
+	}
+
+	Logger::Uninitialize();
+	return passed ? 0 : 1;
+}
@@ -24,20 +24,30 @@ project "ImGui"
     }
 
     includedirs {
-        "%{wks.location}\\external\\glad\\include",
-        "%{wks.location}\\external\\glfw3\\include"
+        "%{wks.location}/external/glad/include",
+        "%{wks.location}/external/glfw3/include"
     }
 
     links { 
         "GLFW",
-        "Glad",
-        "opengl32.lib"
+        "Glad"
     }
     
     filter "system:windows"
         systemversion "latest"
         cppdialect "C++17"
         staticruntime "On"
+
+        links {
+            "opengl32.lib"
+        }
+
+    filter "system:linux"
+        cppdialect "C++17"
+
+        links {
+            "GL"
+        }
         
     filter { "system:windows", "configurations:Release" }
         buildoptions "/MT"
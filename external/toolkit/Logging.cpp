@@ -7,6 +7,9 @@
 #ifdef WINDOWS
 #include <Windows.h>
 #include <DbgHelp.h>
+#elif defined(__linux__)
+#include <execinfo.h>
+#include <cstdlib>
 #endif
 
 std::shared_ptr<spdlog::logger> Logger::myLogger;
@@ -22,7 +25,11 @@ void Logger::Init() {
 	// The default color for trace is the same as info, so we get our color output
 	auto console_sink = dynamic_cast<spdlog::sinks::stdout_color_sink_mt*>(myLogger->sinks().back().get());
 	// and make trace cyan instead
+#ifdef WINDOWS
 	console_sink->set_color(spdlog::level::trace, console_sink->CYAN);
+#else
+	console_sink->set_color(spdlog::level::trace, console_sink->cyan);
+#endif
 
 #ifdef WINDOWS 
 	// Get the process handle
@@ -36,8 +43,10 @@ void Logger::Init() {
 
 void Logger::Uninitialize()
 {
+#ifdef WINDOWS
 	HANDLE process = GetCurrentProcess();
 	SymCleanup(process);
+#endif
 	myLogger = nullptr;
 	spdlog::shutdown();
 }
@@ -119,6 +128,18 @@ std::string Logger::DumpStackTrace()
 		// Append to the output line
 		ss << "\t" << functionName << "@" << file << " line " << line << std::endl;
 	}
+#elif defined(__linux__)
+	// glibc can walk the stack for us, names only show up for symbols that are exported (link with -rdynamic)
+	void* frames[64];
+	int count = backtrace(frames, 64);
+	char** symbols = backtrace_symbols(frames, count);
+	if (symbols != nullptr) {
+		// Bypass this frame
+		for (int i = 1; i < count; i++) {
+			ss << "\t" << symbols[i] << std::endl;
+		}
+		free(symbols);
+	}
 #endif
 
 	// Return the result
@@ -0,0 +1,155 @@
+#include "ShaderCache.h"
+#include "Logging.h"
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+namespace {
+	const uint32_t MAGIC = 0x43444853; // "SHDC"
+	const uint32_t MAX_LENGTH = 64 << 20; // anything bigger is a corrupt header, not a shader
+
+	// What is written ahead of the binary itself
+	struct Header {
+		uint32_t magic;
+		uint32_t format; // the binary format the driver handed back with the binary
+		uint32_t length; // bytes of binary that follow
+	};
+
+	// FNV-1a, carried on from hash so several strings can be mixed into one key
+	uint64_t hashString(const char* text, uint64_t hash) {
+		for (; *text != '\0'; text++) {
+			hash = (hash ^ (uint8_t)*text) * 1099511628211ull;
+		}
+		// a separator, so "ab" + "c" and "a" + "bc" don't collide
+		return (hash ^ 0xFF) * 1099511628211ull;
+	}
+
+	const char* glString(GLenum name) {
+		const char* value = (const char*)glGetString(name);
+		return value != nullptr ? value : "";
+	}
+}
+
+std::string ShaderCache::myDirectory = "shader_cache";
+std::string ShaderCache::myDriver;
+int ShaderCache::myFormatCount = -1;
+uint32_t ShaderCache::myHits = 0;
+uint32_t ShaderCache::myMisses = 0;
+
+bool ShaderCache::__Enabled()
+{
+	if (myDirectory.empty()) {
+		return false;
+	}
+
+	if (myFormatCount < 0) {
+		myFormatCount = 0;
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &myFormatCount);
+		myDriver = std::string(glString(GL_VENDOR)) + "|" + glString(GL_RENDERER) + "|" + glString(GL_VERSION);
+		if (myFormatCount == 0) {
+			LOG_INFO("Shader cache is off, {} has no program binary formats", glString(GL_RENDERER));
+		}
+	}
+	return myFormatCount > 0;
+}
+
+std::string ShaderCache::__Path(const char* vsSource, const char* fsSource)
+{
+	uint64_t hash = 14695981039346656037ull;
+	hash = hashString(myDriver.c_str(), hash);
+	hash = hashString(vsSource, hash);
+	hash = hashString(fsSource, hash);
+
+	char name[32];
+	snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)hash);
+	return (std::filesystem::path(myDirectory) / name).string();
+}
+
+bool ShaderCache::Load(GLuint program, const char* vsSource, const char* fsSource)
+{
+	if (!__Enabled()) {
+		return false;
+	}
+
+	// ask for the program to be retrievable, in case it ends up being linked from source and stored
+	glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+
+	if (__LoadBinary(program, __Path(vsSource, fsSource))) {
+		myHits++;
+		return true;
+	}
+	myMisses++;
+	return false;
+}
+
+bool ShaderCache::__LoadBinary(GLuint program, const std::string& path)
+{
+	std::ifstream file(path, std::ios::binary);
+	if (!file) {
+		return false;
+	}
+
+	Header header;
+	std::vector<char> binary;
+	if (!file.read((char*)&header, sizeof(header)) || header.magic != MAGIC || header.length > MAX_LENGTH) {
+		return false;
+	}
+	binary.resize(header.length);
+	if (!file.read(binary.data(), header.length)) {
+		return false;
+	}
+
+	glProgramBinary(program, header.format, binary.data(), (GLsizei)header.length);
+
+	// the driver is free to turn down a binary it made earlier, say after an update that kept the same version string
+	GLint success = GL_FALSE;
+	glGetProgramiv(program, GL_LINK_STATUS, &success);
+	if (success == GL_FALSE) {
+		LOG_WARN("Cached shader binary {} was rejected by the driver, compiling it from source", path);
+		return false;
+	}
+	return true;
+}
+
+void ShaderCache::Store(GLuint program, const char* vsSource, const char* fsSource)
+{
+	if (!__Enabled()) {
+		return;
+	}
+
+	// some of the toolkit's programs don't check their link status, there is nothing to keep if it failed
+	GLint success = GL_FALSE;
+	glGetProgramiv(program, GL_LINK_STATUS, &success);
+	GLint length = 0;
+	glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+	if (success == GL_FALSE || length <= 0) {
+		return;
+	}
+
+	Header header;
+	header.magic = MAGIC;
+	std::vector<char> binary(length);
+	GLenum format = 0;
+	glGetProgramBinary(program, length, &length, &format, binary.data());
+	header.format = format;
+	header.length = (uint32_t)length;
+
+	// write next to the real file and move it over once it is complete, so a crash never leaves half a binary behind
+	std::string path = __Path(vsSource, fsSource);
+	std::string partial = path + ".tmp";
+	std::error_code error;
+	std::filesystem::create_directories(myDirectory, error);
+	{
+		std::ofstream file(partial, std::ios::binary);
+		if (!file.write((const char*)&header, sizeof(header)) || !file.write(binary.data(), length)) {
+			LOG_WARN("Failed to write shader binary {}", partial);
+			return;
+		}
+	}
+	std::filesystem::rename(partial, path, error);
+	if (error) {
+		LOG_WARN("Failed to write shader binary {}: {}", path, error.message());
+	}
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstdint>
+#include <string>
+
+/*
+	Keeps linked shader programs on disk (glGetProgramBinary), so a program that was linked on an earlier launch is
+	handed straight to the driver instead of being compiled from source again. Compiling is by far the slowest part of
+	starting up on a software rasterizer.
+
+	Entries are keyed by a hash of both sources together with the vendor, renderer and version strings of the driver,
+	so a driver update or a different GPU simply misses. A driver is also free to reject a binary it produced earlier,
+	in which case Load fails and the program gets compiled from source like it would have without the cache.
+
+	Usage, with program a fresh glCreateProgram():
+		if (!ShaderCache::Load(program, vsSource, fsSource)) {
+			... compile, attach and link the sources as usual ...
+			ShaderCache::Store(program, vsSource, fsSource); // once it has linked
+		}
+
+	Needs a current GL context with glad loaded. Does nothing if the driver supports no binary formats
+*/
+class ShaderCache {
+public:
+	// Where the binaries are kept, "shader_cache" in the working directory by default. Empty turns the cache off
+	static void SetDirectory(const std::string& directory) { myDirectory = directory; }
+	static const std::string& GetDirectory() { return myDirectory; }
+
+	// Fills program in from the cache, returns true if it is linked and ready to use. On a miss (or if the driver
+	// rejected the binary) program is left ready to have the sources attached and linked
+	static bool Load(GLuint program, const char* vsSource, const char* fsSource);
+	// Saves a program that has been linked from vsSource and fsSource. Failing to write is logged and otherwise ignored
+	static void Store(GLuint program, const char* vsSource, const char* fsSource);
+
+	static uint32_t GetHitCount() { return myHits; } // programs that came from the cache this launch
+	static uint32_t GetMissCount() { return myMisses; } // programs that had to be compiled, including rejected binaries
+
+private:
+	static bool __Enabled(); // whether there is a directory, and the driver can hand out binaries at all
+	static std::string __Path(const char* vsSource, const char* fsSource); // the file a pair of sources is kept in
+	static bool __LoadBinary(GLuint program, const std::string& path); // false if it's missing, corrupt or rejected
+
+	static std::string myDirectory;
+	static std::string myDriver; // vendor, renderer and version, read once there is a context
+	static int myFormatCount; // GL_NUM_PROGRAM_BINARY_FORMATS, -1 until it has been read
+	static uint32_t myHits, myMisses;
+};
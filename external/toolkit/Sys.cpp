@@ -3,6 +3,11 @@
 #ifdef WINDOWS
 #include "windows.h"
 #include "psapi.h"
+#elif defined(__linux__)
+#include <chrono>
+#include <cstdio>
+#include <sys/resource.h>
+#include <unistd.h>
 #endif
 
 size_t System::GetMemoryUsageBytes() {
@@ -10,6 +15,19 @@ size_t System::GetMemoryUsageBytes() {
 	static PROCESS_MEMORY_COUNTERS pmc;
 	GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc));
 	return pmc.WorkingSetSize;
+	#elif defined(__linux__)
+	// The second number in statm is the resident set size, in pages
+	size_t pages = 0, resident = 0;
+	FILE* statm = fopen("/proc/self/statm", "r");
+	if (statm != nullptr) {
+		if (fscanf(statm, "%zu %zu", &pages, &resident) != 2) {
+			resident = 0;
+		}
+		fclose(statm);
+	}
+	return resident * (size_t)sysconf(_SC_PAGESIZE);
+	#else
+	return 0;
 	#endif
 }
 
@@ -19,6 +37,9 @@ size_t System::GetPageUsageBytes()
 	static PROCESS_MEMORY_COUNTERS pmc;
 	GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc));
 	return pmc.QuotaPagedPoolUsage;
+	#else
+	// Linux has no paged pool quota
+	return 0;
 	#endif
 }
 
@@ -27,6 +48,13 @@ size_t System::GetPeakMemoryUsageBytes() {
 	static PROCESS_MEMORY_COUNTERS pmc;
 	GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc));
 	return pmc.PeakWorkingSetSize;
+	#elif defined(__linux__)
+	// ru_maxrss is in kilobytes on Linux
+	rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return (size_t)usage.ru_maxrss * 1024;
+	#else
+	return 0;
 	#endif
 }
 
@@ -52,12 +80,31 @@ double System::GetCpuUsage()
 	lastSysCPU = sys;
 
 	return percent * 100.0;
+	#elif defined(__linux__)
+	// Same as on Windows, but every time is kept in microseconds
+	unsigned long long now, sys, user;
+	__Times(now, sys, user);
+	if (now == lastCPU) {
+		return 0.0;
+	}
+
+	double percent = (double)((sys - lastSysCPU) + (user - lastUserCPU));
+	percent /= (now - lastCPU);
+	percent /= numProcessors;
+	lastCPU = now;
+	lastUserCPU = user;
+	lastSysCPU = sys;
+
+	return percent * 100.0;
+	#else
+	return 0.0;
 	#endif
 }
 
 void System::__Init() {
 	static bool isInit = false;
 	if (!isInit) {
+		#ifdef WINDOWS
 		SYSTEM_INFO sysInfo;
 		FILETIME ftime, fsys, fuser;
 
@@ -71,11 +118,29 @@ void System::__Init() {
 		GetProcessTimes(self, &ftime, &ftime, &fsys, &fuser);
 		memcpy(&lastSysCPU, &fsys, sizeof(FILETIME));
 		memcpy(&lastUserCPU, &fuser, sizeof(FILETIME));
+		#elif defined(__linux__)
+		numProcessors = (int)sysconf(_SC_NPROCESSORS_ONLN);
+		__Times(lastCPU, lastSysCPU, lastUserCPU);
+		#endif
 
 		isInit = true;
 	}
 }
 
+#ifdef __linux__
+void System::__Times(unsigned long long& now, unsigned long long& sys, unsigned long long& user) {
+	auto toMicros = [](const timeval& time) { return (unsigned long long)time.tv_sec * 1000000ull + time.tv_usec; };
+
+	now = (unsigned long long)std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+
+	rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	sys = toMicros(usage.ru_stime);
+	user = toMicros(usage.ru_utime);
+}
+#endif
+
 int System::numProcessors;
 void* System::self;
 unsigned long long System::lastUserCPU;
@@ -1,4 +1,5 @@
 #pragma once
+#include <cstddef>
 #include <cstdint>
 
 class System
@@ -23,6 +24,10 @@ public:
 		
 private:
 	static void __Init();
+#ifdef __linux__
+	// wall clock, kernel and user time of the process so far, in microseconds
+	static void __Times(unsigned long long& now, unsigned long long& sys, unsigned long long& user);
+#endif
 	
 	static unsigned long long lastCPU, lastSysCPU, lastUserCPU;
 	static int      numProcessors;
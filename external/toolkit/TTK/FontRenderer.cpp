@@ -12,12 +12,14 @@
 
 #include "FontRenderer.h"
 #include <fstream>
+#include <cstring>
 #include "../Logging.h"
+#include "../ShaderCache.h"
 #include <GLM/gtc/matrix_transform.hpp>
 #include "TTKContext.h"
 
-// Implementaiton of readFile
-char* readFile(const char* filename) {
+// Implementaiton of readFile, kept to this file so it can't clash with a readFile in the program linking the toolkit
+static char* readFile(const char* filename) {
 	// Declare and open the file stream
 	std::ifstream file;
 	file.open(filename, std::ios::binary);
@@ -51,100 +53,97 @@ char* readFile(const char* filename) {
 	}
 }
 
-TTK::FontRenderer* TTK::FontRenderer::m_Instance = nullptr;
-
-TTK::TrueTypeTextureFont::TrueTypeTextureFont(const char* fileName, uint32_t size)
-{
-	myFontSize = size;
-
-	unsigned char* fontData = (unsigned char*)readFile(fileName);
-	uint8_t* atlasData = new uint8_t[ATLAS_WIDTH * ATLAS_HEIGHT];
-
-	myCharInfo = new stbtt_packedchar[CHAR_COUNT];
+namespace {
+	// Reads the code point text starts with from UTF-8 and moves text on past it. Anything malformed reads as U+FFFD
+	uint32_t nextCodePoint(const char*& text) {
+		const unsigned char* bytes = (const unsigned char*)text;
+		uint32_t result = bytes[0];
+		int extra;
+		if (result < 0x80) {
+			text++;
+			return result;
+		}
+		else if ((result & 0xE0) == 0xC0) { result &= 0x1F; extra = 1; }
+		else if ((result & 0xF0) == 0xE0) { result &= 0x0F; extra = 2; }
+		else if ((result & 0xF8) == 0xF0) { result &= 0x07; extra = 3; }
+		else {
+			text++;
+			return 0xFFFD;
+		}
 
-	if (!stbtt_InitFont(&myFontInfo, fontData, 0)) {
-		LOG_ERROR("Failed to initialize font");
-		delete[] atlasData;
-		delete[] fontData;
-		return;
+		// the terminator isn't a continuation byte either, so this never reads past the end
+		for (int ix = 1; ix <= extra; ix++) {
+			if ((bytes[ix] & 0xC0) != 0x80) {
+				text += ix;
+				return 0xFFFD;
+			}
+			result = (result << 6) | (bytes[ix] & 0x3F);
+		}
+		text += extra + 1;
+		return result;
 	}
 
-	// Gets the font metrics
-	stbtt_GetFontVMetrics(&myFontInfo, &myAscent, &myDescent, &myLineGap);
-
-	myPixelHeightScale = stbtt_ScaleForPixelHeight(&myFontInfo, (float)size);
-	myEmToPixel = stbtt_ScaleForMappingEmToPixels(&myFontInfo, 1.0f);
-
-	stbtt_pack_context context;
-	if (!stbtt_PackBegin(&context, atlasData, ATLAS_WIDTH, ATLAS_HEIGHT, 0, 1, nullptr)) {
-		LOG_ERROR("Failed to pack font texture");
-		delete[] atlasData;
-		delete[] fontData;
-		return;
+	// FNV-1a over the text and then the pixel size, so finding a layout doesn't have to copy the text anywhere
+	uint64_t layoutKey(const char* text, uint32_t pixelSize) {
+		uint64_t hash = 14695981039346656037ull;
+		for (const char* c = text; *c != '\0'; c++) {
+			hash = (hash ^ (unsigned char)*c) * 1099511628211ull;
+		}
+		return (hash ^ pixelSize) * 1099511628211ull;
 	}
+}
 
-	stbtt_PackSetOversampling(&context, FONT_OVERSAMPLE_X, FONT_OVERSAMPLE_Y);
-	if (!stbtt_PackFontRange(&context, fontData, 0, size, FIRST_CHAR, CHAR_COUNT, myCharInfo)) {
-		LOG_ERROR("Failed to pack font range");
-		delete[] atlasData;
-		delete[] fontData;
-		return;
-	}
-	stbtt_PackEnd(&context);
+TTK::FontRenderer* TTK::FontRenderer::m_Instance = nullptr;
 
-	for (uint32_t ix = FIRST_CHAR; ix < FIRST_CHAR + CHAR_COUNT; ix++) {
-		// TODO: Grab glyph data
-	}
+TTK::TrueTypeTextureFont::TrueTypeTextureFont(const char* fileName, uint32_t size) :
+	myFontData(nullptr),
+	myGeneration(0),
+	myClock(0),
+	myDrawnClock(0)
+{
+	myFontSize = size;
 
-	// Create and upload the texture to store our font in
+	// Create the atlas that glyphs get packed into as they are needed
 	LOG_ASSERT(glGetError() == GL_NONE, "Some error has occured!");
 	glCreateTextures(GL_TEXTURE_2D, 1, &myTexture);
 	glTextureParameteri(myTexture, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
 	glTextureParameteri(myTexture, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-	glTextureParameteri(myTexture, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_LINEAR);
+	glTextureParameteri(myTexture, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 	glTextureParameteri(myTexture, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 	LOG_ASSERT(glGetError() == GL_NONE, "Some error has occured!");
-	glTextureStorage2D(myTexture, 1, GL_R8, ATLAS_WIDTH, ATLAS_HEIGHT);
+	glTextureStorage2D(myTexture, 1, GL_R8, ATLAS_SIZE, ATLAS_SIZE);
 	LOG_ASSERT(glGetError() == GL_NONE, "Internal texture format not supported");
-	glTextureSubImage2D(myTexture, 0, 0, 0, ATLAS_WIDTH, ATLAS_HEIGHT, GL_RED, GL_UNSIGNED_BYTE, atlasData);
-	LOG_ASSERT(glGetError() == GL_NONE, "Texture transfer format not supported");
+	glClearTexImage(myTexture, 0, GL_RED, GL_UNSIGNED_BYTE, nullptr);
 	m_TexHandle = glGetTextureHandleARB(myTexture);
 	glMakeTextureHandleResidentARB(m_TexHandle);
 
-	delete[] atlasData;
-	delete[] fontData;
+	for (Page& page : myPages) {
+		stbrp_init_target(&page.Packer, PAGE_SIZE, PAGE_SIZE, page.Nodes, PAGE_SIZE);
+		page.LastUsed = 0;
+		page.Generation = 0;
+	}
+
+	myFontData = (unsigned char*)readFile(fileName);
+	if (myFontData == nullptr || !stbtt_InitFont(&myFontInfo, myFontData, 0)) {
+		LOG_ERROR("Failed to load font \"{}\"", fileName);
+		delete[] myFontData;
+		myFontData = nullptr;
+		return;
+	}
+
+	// Gets the font metrics
+	stbtt_GetFontVMetrics(&myFontInfo, &myAscent, &myDescent, &myLineGap);
+
+	myPixelHeightScale = stbtt_ScaleForPixelHeight(&myFontInfo, (float)size);
+	myEmToPixel = stbtt_ScaleForMappingEmToPixels(&myFontInfo, 1.0f);
 }
 
 TTK::TrueTypeTextureFont::~TrueTypeTextureFont()
 {
-	delete[] myCharInfo;
+	delete[] myFontData;
 	glDeleteTextures(1, &myTexture);
 }
 
-TTK::GlyphInfo TTK::TrueTypeTextureFont::GetGlyph(int codePoint, float offsetX, float offsetY) const {
-	stbtt_aligned_quad quad;
-
-	stbtt_GetPackedQuad(myCharInfo, ATLAS_WIDTH, ATLAS_HEIGHT, codePoint - FIRST_CHAR, &offsetX, &offsetY, &quad, 1);
-	auto xmin = quad.x0;
-	auto xmax = quad.x1;
-	auto ymin = -quad.y1;
-	auto ymax = -quad.y0;
-
-	GlyphInfo info = GlyphInfo();
-	info.OffsetX = offsetX;
-	info.OffsetY = offsetY;
-	info.Positions[0] = { xmax, -ymin };
-	info.Positions[1] = { xmax, -ymax };
-	info.Positions[2] = { xmin, -ymax };
-	info.Positions[3] = { xmin, -ymin };
-	info.UVs[0] = { quad.s1, quad.t1 };
-	info.UVs[1] = { quad.s1, quad.t0 };
-	info.UVs[2] = { quad.s0, quad.t0 };
-	info.UVs[3] = { quad.s0, quad.t1 };
-
-	return info;
-}
-
 float TTK::TrueTypeTextureFont::GetKerning(int char1, int char2) const {
 	return stbtt_GetCodepointKernAdvance(&myFontInfo, char1, char2) * myPixelHeightScale;
 }
@@ -154,65 +153,290 @@ float TTK::TrueTypeTextureFont::GetLineHeight() const {
 }
 
 glm::vec2 TTK::TrueTypeTextureFont::MeausureString(const char* text, const float scale) {
-	float multiplier = scale;
-
-	glm::vec2 originPos = glm::vec2();
-
-	GlyphInfo glyph;
+	if (myFontData == nullptr) {
+		return glm::vec2();
+	}
 
-	int length = strlen(text);
+	// Only needs the metrics, so this doesn't touch the atlas
+	uint32_t pixelSize = __PixelSize(scale);
+	float pixelScale = stbtt_ScaleForPixelHeight(&myFontInfo, pixelSize * glm::max(1.0f, myFontSize * scale / pixelSize));
 	float xOff{ 0 }, yOff{ 0 };
-	float lineHeight = 0.0f;
 	float maxWidth = 0.0f;
-	float totalHeight = 0.0f;
+	int previous = 0;
+
+	while (*text != '\0') {
+		uint32_t codePoint = nextCodePoint(text);
+		int advance, bearing;
+		if (codePoint == '\n') {
+			maxWidth = glm::max(maxWidth, xOff);
+			yOff += (myAscent - myDescent + myLineGap) * pixelScale;
+			xOff = 0;
+			previous = 0;
+		}
+		else if (codePoint == '\r') {
+			xOff = 0;
+		}
+		else if (codePoint == '\t') {
+			stbtt_GetCodepointHMetrics(&myFontInfo, ' ', &advance, &bearing);
+			xOff += advance * pixelScale * 4;
+		}
+		else {
+			int index = stbtt_FindGlyphIndex(&myFontInfo, codePoint);
+			if (previous != 0) {
+				xOff += stbtt_GetGlyphKernAdvance(&myFontInfo, previous, index) * pixelScale;
+			}
+			stbtt_GetGlyphHMetrics(&myFontInfo, index, &advance, &bearing);
+			xOff += advance * pixelScale;
+			previous = index;
+		}
+	}
+	maxWidth = glm::max(maxWidth, xOff);
+	return glm::vec2(maxWidth, yOff + (myAscent - myDescent) * pixelScale);
+}
 
-	for (int i = 0; i < length; i++) {
-		glyph = GetGlyph(text[i], xOff, yOff);
-		xOff = glyph.OffsetX;
-		yOff = glyph.OffsetY;
+uint32_t TTK::TrueTypeTextureFont::__PixelSize(float scale) const {
+	float size = myFontSize * scale + 0.5f;
+	return size < 1.0f ? 1 : glm::min((uint32_t)size, MAX_PIXEL_SIZE);
+}
 
-		lineHeight = glm::max(lineHeight, -glyph.Positions[1].y);
-		maxWidth = glm::max(maxWidth, xOff);
+const TTK::TrueTypeTextureFont::Layout* TTK::TrueTypeTextureFont::__GetLayout(const char* text, uint32_t pixelSize) {
+	static_assert(PAGE_COUNT <= 32, "Layout::Pages has a bit for each page");
+
+	myClock++;
+
+	// a layout is only stale if one of the pages it draws from has been emptied since, and a different string that
+	// hashes the same is laid out again over it
+	uint64_t key = layoutKey(text, pixelSize);
+	auto it = myLayouts.find(key);
+	if (it != myLayouts.end() && it->second.PixelSize == pixelSize && it->second.Text == text) {
+		bool valid = true;
+		for (uint32_t page = 0; page < PAGE_COUNT; page++) {
+			if ((it->second.Pages & (1u << page)) && myPages[page].Generation > it->second.Generation) {
+				valid = false;
+			}
+		}
+		if (valid) {
+			it->second.LastUsed = myClock;
+			for (uint32_t page = 0; page < PAGE_COUNT; page++) {
+				if (it->second.Pages & (1u << page)) {
+					myPages[page].LastUsed = myClock;
+				}
+			}
+			return &it->second;
+		}
+	}
 
-		if (text[i] == '\n')
-		{
-			yOff += GetLineHeight() * multiplier;
-			totalHeight += lineHeight;
-			lineHeight = 0.0f;
-			xOff = 0;
+	// forget the layouts that have already been drawn once there are too many, that's most of them when text is
+	// changing every frame
+	if (it == myLayouts.end() && myLayouts.size() >= MAX_LAYOUTS) {
+		for (auto entry = myLayouts.begin(); entry != myLayouts.end(); ) {
+			entry = entry->second.LastUsed <= myDrawnClock ? myLayouts.erase(entry) : std::next(entry);
 		}
-		else if (text[i] == '\r') {
-			xOff = 0;
+	}
+
+	Layout& layout = myLayouts[key];
+	layout.Text = text;
+	layout.PixelSize = pixelSize;
+	layout.Glyphs.clear();
+	layout.Pages = 0;
+	layout.LastUsed = myClock;
+
+	if (myFontData != nullptr) {
+		float pixelScale = stbtt_ScaleForPixelHeight(&myFontInfo, (float)pixelSize);
+		float lineHeight = (myAscent - myDescent + myLineGap) * pixelScale;
+		float xOff{ 0 }, yOff{ 0 };
+		int previous = 0;
+
+		while (*text != '\0') {
+			uint32_t codePoint = nextCodePoint(text);
+			if (codePoint == '\n') {
+				yOff += lineHeight;
+				xOff = 0;
+				previous = 0;
+				continue;
+			}
+			else if (codePoint == '\r') {
+				xOff = 0;
+				continue;
+			}
+
+			const CachedGlyph* glyph = __GetGlyph(codePoint == '\t' ? ' ' : codePoint, pixelSize);
+			if (glyph == nullptr) {
+				myLayouts.erase(key);
+				return nullptr;
+			}
+
+			if (codePoint == '\t') {
+				xOff += glyph->XAdvance * 4;
+				previous = 0;
+				continue;
+			}
+			if (previous != 0) {
+				xOff += stbtt_GetGlyphKernAdvance(&myFontInfo, previous, glyph->Index) * pixelScale;
+			}
+			previous = glyph->Index;
+
+			if (glyph->Page >= 0) {
+				// snapped to whole pixels like stbtt_GetPackedQuad, so glyphs stay crisp
+				float x0 = floorf(xOff + glyph->XOff + 0.5f);
+				float y0 = floorf(yOff + glyph->YOff + 0.5f);
+				float x1 = x0 + glyph->XOff2 - glyph->XOff;
+				float y1 = y0 + glyph->YOff2 - glyph->YOff;
+
+				GlyphInfo info = GlyphInfo();
+				info.Positions[0] = { x1, y1 };
+				info.Positions[1] = { x1, y0 };
+				info.Positions[2] = { x0, y0 };
+				info.Positions[3] = { x0, y1 };
+				info.UVs[0] = { glyph->S1, glyph->T1 };
+				info.UVs[1] = { glyph->S1, glyph->T0 };
+				info.UVs[2] = { glyph->S0, glyph->T0 };
+				info.UVs[3] = { glyph->S0, glyph->T1 };
+				xOff += glyph->XAdvance;
+				info.OffsetX = xOff;
+				info.OffsetY = yOff;
+				layout.Glyphs.push_back(info);
+				layout.Pages |= 1u << glyph->Page;
+			}
+			else {
+				xOff += glyph->XAdvance;
+			}
+		}
+	}
+
+	// set last, a page might have been emptied while laying this out
+	layout.Generation = myGeneration;
+	return &layout;
+}
+
+const TTK::TrueTypeTextureFont::CachedGlyph* TTK::TrueTypeTextureFont::__GetGlyph(uint32_t codePoint, uint32_t pixelSize) {
+	uint64_t key = ((uint64_t)pixelSize << 32) | codePoint;
+	auto it = myGlyphs.find(key);
+	if (it != myGlyphs.end()) {
+		if (it->second.Page >= 0) {
+			myPages[it->second.Page].LastUsed = myClock;
 		}
-		else if (text[i] == '\t') {
-			float xOffTemp{ 0 }, yOffTemp{ 0 };
-			glyph = GetGlyph(' ', xOffTemp, yOffTemp);
-			xOff += glyph.OffsetX * 4;
+		return &it->second;
+	}
+
+	float scale = stbtt_ScaleForPixelHeight(&myFontInfo, (float)pixelSize);
+	CachedGlyph glyph = CachedGlyph();
+	glyph.Index = stbtt_FindGlyphIndex(&myFontInfo, codePoint);
+	glyph.Page = -1;
+	int advance, bearing;
+	stbtt_GetGlyphHMetrics(&myFontInfo, glyph.Index, &advance, &bearing);
+	glyph.XAdvance = advance * scale;
+
+	if (!stbtt_IsGlyphEmpty(&myFontInfo, glyph.Index)) {
+		// small text is rasterized at a higher resolution and filtered down, it doesn't help bigger glyphs much and
+		// would take four times as much of the atlas
+		int oversampleX = pixelSize < OVERSAMPLE_BELOW ? FONT_OVERSAMPLE_X : 1;
+		int oversampleY = pixelSize < OVERSAMPLE_BELOW ? FONT_OVERSAMPLE_Y : 1;
+
+		// Sized the same way stbtt_PackFontRange does it, with room for the oversampling and a pixel of padding
+		int x0, y0, x1, y1;
+		stbtt_GetGlyphBitmapBoxSubpixel(&myFontInfo, glyph.Index, scale * oversampleX, scale * oversampleY, 0, 0, &x0, &y0, &x1, &y1);
+		int width = x1 - x0 + oversampleX - 1;
+		int height = y1 - y0 + oversampleY - 1;
+
+		stbrp_rect rect = stbrp_rect();
+		rect.w = width + 1;
+		rect.h = height + 1;
+		int page = __Pack(rect);
+		if (page < 0) {
+			return nullptr;
 		}
+		int atlasX = (page % PAGES_PER_ROW) * PAGE_SIZE + rect.x;
+		int atlasY = (page / PAGES_PER_ROW) * PAGE_SIZE + rect.y;
+
+		// rows are padded out to 4 bytes, so the upload works with the default unpack alignment
+		int stride = (width + 3) & ~3;
+		std::vector<unsigned char> pixels(stride * height);
+		float subX, subY;
+		stbtt_MakeGlyphBitmapSubpixelPrefilter(&myFontInfo, pixels.data(), width, height, stride, scale * oversampleX,
+			scale * oversampleY, 0, 0, oversampleX, oversampleY, &subX, &subY, glyph.Index);
+		glTextureSubImage2D(myTexture, 0, atlasX, atlasY, width, height, GL_RED, GL_UNSIGNED_BYTE, pixels.data());
+
+		glyph.Page = page;
+		glyph.S0 = atlasX / (float)ATLAS_SIZE;
+		glyph.T0 = atlasY / (float)ATLAS_SIZE;
+		glyph.S1 = (atlasX + width) / (float)ATLAS_SIZE;
+		glyph.T1 = (atlasY + height) / (float)ATLAS_SIZE;
+		glyph.XOff = x0 / (float)oversampleX + subX;
+		glyph.YOff = y0 / (float)oversampleY + subY;
+		glyph.XOff2 = (x0 + width) / (float)oversampleX + subX;
+		glyph.YOff2 = (y0 + height) / (float)oversampleY + subY;
+		myPages[page].LastUsed = myClock;
+	}
+
+	return &(myGlyphs[key] = glyph);
+}
+
+int TTK::TrueTypeTextureFont::__Pack(stbrp_rect& rect) {
+	for (uint32_t page = 0; page < PAGE_COUNT; page++) {
+		if (stbrp_pack_rects(&myPages[page].Packer, &rect, 1)) {
+			return page;
+		}
+	}
+
+	// Every page is full
+	int page = __EvictPage();
+	if (page >= 0 && stbrp_pack_rects(&myPages[page].Packer, &rect, 1)) {
+		return page;
 	}
-	GlyphInfo space = GetGlyph('|', xOff, yOff);
-	yOff += -(space.Positions[1].y - space.Positions[0].y);
-	return glm::vec2(xOff, yOff);
+	return -1;
+}
+
+int TTK::TrueTypeTextureFont::__EvictPage() {
+	uint32_t oldest = 0;
+	for (uint32_t page = 1; page < PAGE_COUNT; page++) {
+		if (myPages[page].LastUsed < myPages[oldest].LastUsed) {
+			oldest = page;
+		}
+	}
+	// the text waiting to be drawn still needs what is in it
+	if (myPages[oldest].LastUsed > myDrawnClock) {
+		return -1;
+	}
+
+	for (auto it = myGlyphs.begin(); it != myGlyphs.end(); ) {
+		it = it->second.Page == (int)oldest ? myGlyphs.erase(it) : std::next(it);
+	}
+	stbrp_init_target(&myPages[oldest].Packer, PAGE_SIZE, PAGE_SIZE, myPages[oldest].Nodes, PAGE_SIZE);
+	glClearTexSubImage(myTexture, 0, (oldest % PAGES_PER_ROW) * PAGE_SIZE, (oldest / PAGES_PER_ROW) * PAGE_SIZE, 0,
+		PAGE_SIZE, PAGE_SIZE, 1, GL_RED, GL_UNSIGNED_BYTE, nullptr);
+
+	// layouts that were using the page get laid out again the next time they're drawn, the rest are still good
+	myPages[oldest].Generation = ++myGeneration;
+	return oldest;
 }
 
 TTK::FontRenderer::~FontRenderer()
 {
-	glDeleteShader(m_ShaderHandle);
+	glDeleteProgram(m_ShaderHandle);
 	glDeleteVertexArrays(1, &m_VAO);
+	glDeleteBuffers(1, &m_EBO);
 }
 
-void TTK::FontRenderer::Render(const TrueTypeTextureFont& font, const char* text, const glm::vec2& pos, const glm::vec4& color, float scale)
+void TTK::FontRenderer::Render(TrueTypeTextureFont& font, const char* text, const glm::vec2& pos, const glm::vec4& color, float scale)
 {
-	size_t length = strlen(text);
-	
-	float multiplier = scale;
-
-	// The number of quads ACTUALLY drawn Shit-For-Brains
-	int quads = 0;
-
-	glm::vec2 originPos = glm::vec2(pos.x, pos.y);
+	// a batch is drawn from one atlas
+	if (m_Font != nullptr && m_Font != &font) {
+		Flush();
+	}
 
-	static GlyphInfo glyph;
+	uint32_t pixelSize = font.__PixelSize(scale);
+	const TrueTypeTextureFont::Layout* layout = font.__GetLayout(text, pixelSize);
+	if (layout == nullptr) {
+		// the atlas needs a page back that we still have to draw from, so draw it and try again
+		Flush();
+		font.myDrawnClock = font.myClock;
+		layout = font.__GetLayout(text, pixelSize);
+		if (layout == nullptr) {
+			LOG_WARN("Not enough room in the font atlas to draw \"{}\"", text);
+			return;
+		}
+	}
 
 	Col8 gpuCol;
 	gpuCol.R = color.r * 255;
@@ -220,106 +444,90 @@ void TTK::FontRenderer::Render(const TrueTypeTextureFont& font, const char* text
 	gpuCol.B = color.b * 255;
 	gpuCol.A = color.a * 255;
 
-	float xOff{ 0 }, yOff{ 0 };
-
-	for (int i = 0; i < length; i++) {
-		glyph = font.GetGlyph(text[i], xOff, yOff);
-		xOff = glyph.OffsetX;
-		yOff = glyph.OffsetY;
+	// text bigger than the biggest size glyphs are rasterized at is stretched
+	float stretch = glm::max(1.0f, font.myFontSize * scale / pixelSize);
 
-		if (text[i] == '\n')
-		{
-			yOff += font.GetLineHeight() * multiplier;
-			xOff = 0;
+	m_Font = &font;
+	for (const GlyphInfo& glyph : layout->Glyphs) {
+		for (int ix = 0; ix < 4; ix++) {
+			m_Verts.push_back({ pos + glyph.Positions[ix] * stretch, gpuCol, glyph.UVs[ix] });
 		}
-		else if (text[i] == '\r') {
-			xOff = 0;
-		}
-		else if (text[i] == '\t') {
-			float xOffTemp{ 0 }, yOffTemp{ 0 };
-			glyph = font.GetGlyph(' ', xOffTemp, yOffTemp);
-			xOff += glyph.OffsetX * 4;
-		}
-		else {
-			m_MeshData[quads * 4 + 0].Position = originPos + glyph.Positions[0] * multiplier;
-			m_MeshData[quads * 4 + 0].UV = glyph.UVs[0];
-			m_MeshData[quads * 4 + 0].Color = gpuCol;
-
-			m_MeshData[quads * 4 + 1].Position = originPos + glyph.Positions[1] * multiplier;
-			m_MeshData[quads * 4 + 1].UV = glyph.UVs[1];
-			m_MeshData[quads * 4 + 1].Color = gpuCol;
-
-			m_MeshData[quads * 4 + 2].Position = originPos + glyph.Positions[2] * multiplier;
-			m_MeshData[quads * 4 + 2].UV = glyph.UVs[2];
-			m_MeshData[quads * 4 + 2].Color = gpuCol;
-
-			m_MeshData[quads * 4 + 3].Position = originPos + glyph.Positions[3] * multiplier;
-			m_MeshData[quads * 4 + 3].UV = glyph.UVs[3];
-			m_MeshData[quads * 4 + 3].Color = gpuCol;
-
+	}
+}
 
-			m_IndexData[quads * 6 + 0] = quads * 4 + 0;
-			m_IndexData[quads * 6 + 1] = quads * 4 + 1;
-			m_IndexData[quads * 6 + 2] = quads * 4 + 2;
+void TTK::FontRenderer::Flush()
+{
+	if (m_Verts.size() > 0) {
+		size_t quads = m_Verts.size() / 4;
+		__ReserveIndices(quads);
+		size_t offset = m_Stream.Upload(m_Verts.data(), m_Verts.size() * sizeof(Vert));
+		glVertexArrayVertexBuffer(m_VAO, 0, m_Stream.GetHandle(), offset, sizeof(Vert));
+
+		// Update and render our meshes
+		bool blendState = glIsEnabled(GL_BLEND);
+		GLboolean depthMaskEnabled = false;
+		glGetBooleanv(GL_DEPTH_WRITEMASK, &depthMaskEnabled);
+		glDepthMask(GL_FALSE);
+		glEnable(GL_BLEND);
+		glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ZERO);
+		glGetError();
+		glm::mat4 proj = TTK::Context::Instance().GetOrthoProjection();
+		glUseProgram(m_ShaderHandle);
+		glProgramUniformMatrix4fv(m_ShaderHandle, 0, 1, false, &proj[0][0]);
+		glProgramUniformHandleui64ARB(m_ShaderHandle, 1, m_Font->m_TexHandle);
+		glBindVertexArray(m_VAO);
+		glDrawElements(GL_TRIANGLES, (GLsizei)(quads * 6), GL_UNSIGNED_INT, nullptr);
+		LOG_ASSERT(glGetError() == GL_NONE, "Failed to draw our text mesh!");
+		if (!blendState) glDisable(GL_BLEND);
+		glDepthMask(depthMaskEnabled);
+
+		m_Verts.clear();
+	}
 
-			m_IndexData[quads * 6 + 3] = quads * 4 + 0;
-			m_IndexData[quads * 6 + 4] = quads * 4 + 2;
-			m_IndexData[quads * 6 + 5] = quads * 4 + 3;
+	// the draw is queued up ahead of anything that changes the atlas after this, so all of it can be reused now
+	if (m_Font != nullptr) {
+		m_Font->myDrawnClock = m_Font->myClock;
+		m_Font = nullptr;
+	}
+}
 
-			quads++;
-		}
+void TTK::FontRenderer::__ReserveIndices(size_t quads) {
+	if (quads <= m_IndexQuads) {
+		return;
 	}
 
-	length = quads;
-
-	// Update and render our meshes
-	bool blendState = glIsEnabled(GL_BLEND);
-	GLboolean depthMaskEnabled = false;
-	glGetBooleanv(GL_DEPTH_WRITEMASK, &depthMaskEnabled);
-	glDepthMask(GL_FALSE);
-	glEnable(GL_BLEND);
-	glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ZERO);
-	glGetError();
-	glm::mat4 proj = TTK::Context::Instance().GetOrthoProjection();
-	glUseProgram(m_ShaderHandle);
-	glProgramUniformMatrix4fv(m_ShaderHandle, 0, 1, false, &proj[0][0]);
-	glProgramUniformHandleui64ARB(m_ShaderHandle, 1, font.m_TexHandle);	
-	glBindVertexArray(m_VAO);
-	glNamedBufferSubData(m_VBO, 0, length * 4 * sizeof(Vert), m_MeshData);
-	glNamedBufferSubData(m_EBO, 0, length * 6 * sizeof(GLuint), m_IndexData);
-	glDrawElements(GL_TRIANGLES, length * 6, GL_UNSIGNED_INT, nullptr);
-	glBindVertexArray(0);
-	LOG_ASSERT(glGetError() == GL_NONE, "Failed to draw our text mesh!");
-	if (!blendState) glDisable(GL_BLEND);
-	glDepthMask(depthMaskEnabled);
+	m_IndexQuads = glm::max(quads, m_IndexQuads * 2);
+	std::vector<GLuint> indices(m_IndexQuads * 6);
+	for (size_t quad = 0; quad < m_IndexQuads; quad++) {
+		GLuint first = (GLuint)(quad * 4);
+		indices[quad * 6 + 0] = first + 0;
+		indices[quad * 6 + 1] = first + 1;
+		indices[quad * 6 + 2] = first + 2;
+		indices[quad * 6 + 3] = first + 0;
+		indices[quad * 6 + 4] = first + 2;
+		indices[quad * 6 + 5] = first + 3;
+	}
+	glNamedBufferData(m_EBO, indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
 }
 
-TTK::FontRenderer::FontRenderer() {
+TTK::FontRenderer::FontRenderer() :
+	m_IndexQuads(0),
+	m_Font(nullptr)
+{
 	LOG_INFO("Initializing font renderer");
 
-	memset(m_MeshData, 0, sizeof(m_MeshData));
-	memset(m_IndexData, 0, sizeof(m_IndexData));
-
+	// Vertices come from the stream buffer, wherever each flush put them
 	glCreateVertexArrays(1, &m_VAO);
-	glBindVertexArray(m_VAO);
-	GLuint buffers[2];
-	glCreateBuffers(2, buffers);
-	glBindBuffer(GL_ARRAY_BUFFER, buffers[0]);
-	glNamedBufferData(buffers[0], 256 * 4 * sizeof(Vert), m_MeshData, GL_DYNAMIC_DRAW);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers[1]);
-	glNamedBufferData(buffers[1], 256 * 6 * sizeof(GLuint), m_IndexData, GL_DYNAMIC_DRAW);
-	glEnableVertexAttribArray(0);
-	glEnableVertexAttribArray(1);
-	glEnableVertexAttribArray(2);
-	Vert v;
-	glVertexAttribPointer(0, 3, GL_FLOAT, false, sizeof(Vert), (void*)offsetof(Vert, Position));
-	glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, false, sizeof(Vert), (void*)offsetof(Vert, Color));
-	glVertexAttribPointer(2, 2, GL_FLOAT, false, sizeof(Vert), (void*)offsetof(Vert, UV));
-	
-	glBindVertexArray(0);
-
-	m_VBO = buffers[0];
-	m_EBO = buffers[1];
+	glCreateBuffers(1, &m_EBO);
+	glVertexArrayElementBuffer(m_VAO, m_EBO);
+	glVertexArrayAttribFormat(m_VAO, 0, 2, GL_FLOAT, false, offsetof(Vert, Position));
+	glVertexArrayAttribFormat(m_VAO, 1, 4, GL_UNSIGNED_BYTE, true, offsetof(Vert, Color));
+	glVertexArrayAttribFormat(m_VAO, 2, 2, GL_FLOAT, false, offsetof(Vert, UV));
+	for (GLuint attrib = 0; attrib < 3; attrib++) {
+		glEnableVertexArrayAttrib(m_VAO, attrib);
+		glVertexArrayAttribBinding(m_VAO, attrib, 0);
+	}
+	__ReserveIndices(256);
 
 	const char* vsSource = R"LIT(#version 430
             layout (location = 0) in vec2 vertexPosition;
@@ -342,33 +550,36 @@ TTK::FontRenderer::FontRenderer() {
             out vec4 frag_color;            	
             void main() {
                 frag_color = fragColor;
-				frag_color.a = texture2D(xSampler, fragUv).r;
+				frag_color.a *= texture(xSampler, fragUv).r;
             })LIT";
 
 	m_ShaderHandle = glCreateProgram();
 
-	GLuint programs[2];
-	programs[0] = glCreateShader(GL_VERTEX_SHADER);
-	glShaderSource(programs[0], 1, &vsSource, NULL);
-	glCompileShader(programs[0]);
-	programs[1] = glCreateShader(GL_FRAGMENT_SHADER);
-	glShaderSource(programs[1], 1, &fsSource, NULL);
-	glCompileShader(programs[1]);
+	// Programs that were linked on an earlier launch come straight from the cache
+	if (!ShaderCache::Load(m_ShaderHandle, vsSource, fsSource)) {
+		GLuint programs[2];
+		programs[0] = glCreateShader(GL_VERTEX_SHADER);
+		glShaderSource(programs[0], 1, &vsSource, NULL);
+		glCompileShader(programs[0]);
+		programs[1] = glCreateShader(GL_FRAGMENT_SHADER);
+		glShaderSource(programs[1], 1, &fsSource, NULL);
+		glCompileShader(programs[1]);
 	
-	// Attach our two shaders
-	glAttachShader(m_ShaderHandle, programs[0]);
-	glAttachShader(m_ShaderHandle, programs[1]);
+		// Attach our two shaders
+		glAttachShader(m_ShaderHandle, programs[0]);
+		glAttachShader(m_ShaderHandle, programs[1]);
 
-	// Perform linking
-	glLinkProgram(m_ShaderHandle);
+		// Perform linking
+		glLinkProgram(m_ShaderHandle);
 
-	// Remove shader parts to save space
-	glDetachShader(m_ShaderHandle, programs[0]);
-	glDeleteShader(programs[0]);
-	glDetachShader(m_ShaderHandle, programs[1]);
-	glDeleteShader(programs[1]);
+		// Remove shader parts to save space
+		glDetachShader(m_ShaderHandle, programs[0]);
+		glDeleteShader(programs[0]);
+		glDetachShader(m_ShaderHandle, programs[1]);
+		glDeleteShader(programs[1]);
+
+		ShaderCache::Store(m_ShaderHandle, vsSource, fsSource);
+	}
 
-	glBindVertexArray(0);
-	
 	LOG_INFO("Done initilaizing font renderer");
 }
@@ -15,7 +15,12 @@
 
 #include "GLM/glm.hpp"
 #include "glad/glad.h"
+#include "stb_rect_pack.h"
 #include "stb_truetype.h"
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "StreamBuffer.h"
 
 namespace  TTK
 {
@@ -45,32 +50,74 @@ namespace  TTK
 
 	class FontRenderer;
 	
+	// A TrueType font whose glyphs are rasterized the first time they are drawn, at the pixel size they are drawn at,
+	// into an atlas split up into pages. Once the atlas is full the page drawn from longest ago is emptied, so any
+	// number of sizes and any part of Unicode can be drawn without the atlas growing. The layout of every string drawn
+	// lately is kept as well, so text that doesn't change from one frame to the next is only laid out once
 	class TrueTypeTextureFont {
 	public:
+		// size is the pixel height of the text drawn with a scale of 1
 		TrueTypeTextureFont(const char* fileName, uint32_t size);
 		~TrueTypeTextureFont();
 		
-		GlyphInfo GetGlyph(int codePoint, float offsetX, float offsetY) const;
 		float  GetKerning(int char1, int char2) const;
 		float  GetLineHeight() const;
 
+		// Width of the widest line, and the height from the top of the first line to the bottom of the last
 		virtual glm::vec2 MeausureString(const char* text, const float scale = 1.0f);
 
 		virtual GLint GetTexture() const { return myTexture; }
 
 	protected:
 		friend class FontRenderer;
-		GLuint   myTexture;
-		GLuint64 m_TexHandle;
 
-		const uint32_t ATLAS_WIDTH = 1024;
-		const uint32_t ATLAS_HEIGHT = 1024;
+		// A string laid out at one pixel size, the glyph positions are relative to the start of its first baseline
+		struct Layout {
+			std::string Text; // what was laid out, layouts are found by a hash of it so this tells two strings apart
+			uint32_t PixelSize;
+			std::vector<GlyphInfo> Glyphs; // one for every glyph that has something to draw
+			uint32_t Pages; // a bit for every atlas page the glyphs are in
+			uint32_t Generation; // myGeneration when it was laid out, glyphs are gone from any of its pages emptied since
+			uint64_t LastUsed;
+		};
+		// Where a glyph is in the atlas, and where to draw it relative to the pen (like a stbtt_packedchar)
+		struct CachedGlyph {
+			int   Index; // in the font, for kerning
+			int   Page; // -1 for glyphs there is nothing to draw for, like spaces
+			float S0, T0, S1, T1;
+			float XOff, YOff, XOff2, YOff2;
+			float XAdvance;
+		};
+
+		static const uint32_t ATLAS_SIZE = 1024;
+		static const uint32_t PAGE_SIZE = 256; // pages are squares in a grid across the atlas
+		static const uint32_t PAGES_PER_ROW = ATLAS_SIZE / PAGE_SIZE;
+		static const uint32_t PAGE_COUNT = PAGES_PER_ROW * PAGES_PER_ROW;
+		static const uint32_t MAX_PIXEL_SIZE = 96; // so that a glyph always fits in an empty page, bigger text is stretched
+		static const uint32_t MAX_LAYOUTS = 256; // layouts kept once they are no longer being drawn
 		const uint32_t FONT_OVERSAMPLE_X = 2;
 		const uint32_t FONT_OVERSAMPLE_Y = 2;
-		const uint32_t FIRST_CHAR = ' ';
-		const uint32_t CHAR_COUNT = '~' - ' ';
+		const uint32_t OVERSAMPLE_BELOW = 40; // pixel size from which glyphs are big enough to go without oversampling
+
+		struct Page {
+			stbrp_context Packer;
+			stbrp_node    Nodes[PAGE_SIZE];
+			uint64_t      LastUsed; // myClock the last time a layout used a glyph in it
+			uint32_t      Generation; // myGeneration when it was last emptied
+		};
 
-		stbtt_packedchar* myCharInfo;
+		// Lays text out at pixelSize. Returns nullptr if a glyph needed room in the atlas, and the only page that could
+		// be emptied for it has text waiting to be drawn from it, the FontRenderer draws that text and asks again
+		const Layout* __GetLayout(const char* text, uint32_t pixelSize);
+		const CachedGlyph* __GetGlyph(uint32_t codePoint, uint32_t pixelSize); // nullptr if there is no room for it
+		int __Pack(stbrp_rect& rect); // finds room for rect in a page and returns which one, -1 if there is none
+		int __EvictPage(); // empties the least recently used page and returns it, -1 if it has text waiting to be drawn
+		uint32_t __PixelSize(float scale) const;
+
+		GLuint   myTexture;
+		GLuint64 m_TexHandle;
+
+		unsigned char*    myFontData; // myFontInfo reads from this for as long as the font is around
 		uint32_t          myFontSize;
 		stbtt_fontinfo    myFontInfo;
 		float             myPixelHeightScale;
@@ -78,6 +125,13 @@ namespace  TTK
 		int               myAscent,
 						  myDescent,
 						  myLineGap;
+
+		Page              myPages[PAGE_COUNT];
+		std::unordered_map<uint64_t, CachedGlyph> myGlyphs; // keyed by pixel size and code point
+		std::unordered_map<uint64_t, Layout>      myLayouts; // keyed by a hash of the text and pixel size
+		uint32_t          myGeneration; // goes up every time a page is emptied
+		uint64_t          myClock; // goes up with every layout handed out, for working out what was used least recently
+		uint64_t          myDrawnClock; // myClock when the FontRenderer last drew, anything used after that is yet to be drawn
 	};
 	
 	class FontRenderer {
@@ -104,14 +158,23 @@ namespace  TTK
 	public:
 		~FontRenderer();
 
-		void Render(const TrueTypeTextureFont& font, const char* text, const glm::vec2& pos, const glm::vec4& color, float scale = 1.0f);
+		// Queues text up to be drawn by the next Flush, along with everything else rendered with the same font since.
+		// Text rendered through the Context is flushed with the Context
+		void Render(TrueTypeTextureFont& font, const char* text, const glm::vec2& pos, const glm::vec4& color, float scale = 1.0f);
+		// Draws everything rendered since the last flush, with one upload and one draw call
+		void Flush();
 		
 	private:
 		FontRenderer();
+
+		void __ReserveIndices(size_t quads); // grows the index buffer to have room for at least quads quads
 				
 		GLuint   m_ShaderHandle;
-		GLuint   m_VAO, m_VBO, m_EBO;
-		Vert     m_MeshData[256 * 4];
-		GLuint   m_IndexData[256 * 6];
+		GLuint   m_VAO, m_EBO;
+		size_t   m_IndexQuads; // quads there are indices for, they are the same for every quad so never change
+
+		std::vector<Vert>    m_Verts; // four for each glyph rendered since the last flush
+		TrueTypeTextureFont* m_Font; // the font m_Verts are from, null if there aren't any
+		StreamBuffer         m_Stream;
 	};
 }
\ No newline at end of file
@@ -13,7 +13,7 @@
 
 #include "GraphicsUtils.h"
 #include "TTKContext.h"
-#include <GLM/gtc/matrix_transform.inl>
+#include <GLM/gtc/matrix_transform.hpp>
 
 #include "imgui.h"
 #include "imgui_impl_glfw.h"
@@ -209,7 +209,7 @@ void TTK::Graphics::DrawPoint(float* p0, float pointSize, float* colour) {
 
 void TTK::Graphics::DrawCube(const glm::vec3& p0, float size, const glm::vec4& colour) {
 	glm::mat4 transform = glm::translate(glm::mat4(1.0f), p0) * glm::scale(glm::mat4(1.0f), glm::vec3(size));
-	TTK::Context::Instance().DrawCube(transform, colour);
+	TTK::Context::Instance().AddCube(transform, colour);
 }
 
 void TTK::Graphics::DrawCube(float* p0, float size, float* colour) {
@@ -219,29 +219,29 @@ void TTK::Graphics::DrawCube(float* p0, float size, float* colour) {
 void TTK::Graphics::DrawTeapot(const glm::vec3& p0, float size, const glm::vec4 colour)
 {
 	glm::mat4 transform = glm::translate(glm::mat4(1.0f), p0) * glm::scale(glm::mat4(1.0f), glm::vec3(size));
-	TTK::Context::Instance().DrawTeapot(transform, colour);
+	TTK::Context::Instance().AddTeapot(transform, colour);
 }
 
 void TTK::Graphics::DrawTeapot(float* p0, float size, float* colour)
 {
 	glm::mat4 transform = glm::translate(glm::mat4(1.0f), *(glm::vec3*)p0) * glm::scale(glm::mat4(1.0f), glm::vec3(size));
-	TTK::Context::Instance().DrawTeapot(transform, DEFAULT_BLACK(colour));
+	TTK::Context::Instance().AddTeapot(transform, DEFAULT_BLACK(colour));
 }
 
 void TTK::Graphics::DrawSphere(const glm::vec3& center, float size, const glm::vec4& colour) {
 	glm::mat4 transform = glm::translate(glm::mat4(1.0f), center) * glm::scale(glm::mat4(1.0f), glm::vec3(size));
-	TTK::Context::Instance().DrawSphere(transform, colour);
+	TTK::Context::Instance().AddSphere(transform, colour);
 }
 
 void TTK::Graphics::DrawSphere(const glm::mat4& p0, float size, const glm::vec4& colour) {
-	TTK::Context::Instance().DrawSphere(p0, colour);
+	TTK::Context::Instance().AddSphere(p0, colour);
 }
 
 void TTK::Graphics::DrawSphere(const glm::mat4& transform, const glm::vec4& colour) {
-	TTK::Context::Instance().DrawSphere(transform, colour);
+	TTK::Context::Instance().AddSphere(transform, colour);
 }
 
 void TTK::Graphics::DrawSphere(float* p0, float size, float* colour) {
 	glm::mat4 transform = glm::translate(glm::mat4(1.0f), *(glm::vec3*)p0) * glm::scale(glm::mat4(1.0f), glm::vec3(size));
-	TTK::Context::Instance().DrawSphere(transform, DEFAULT_BLACK(colour));
+	TTK::Context::Instance().AddSphere(transform, DEFAULT_BLACK(colour));
 }
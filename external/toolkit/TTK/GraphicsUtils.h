@@ -14,7 +14,7 @@
 #define GRAPHICS_UTILS_H
 
 #include <string>
-#include <glm/glm.hpp>
+#include <GLM/glm.hpp>
 
 struct GLFWwindow;
 
@@ -144,8 +144,8 @@ namespace TTK
 
 		// Description:
 		// Draws a cube at position p0 with the specified size
-		// This will set the camera mode to model view, push matrix apply the
-		// cube's transformation and pop matrix
+		// Like the lines and points, cubes, teapots and spheres are batched up
+		// and drawn at EndFrame, one instanced draw call for each mesh
 		// Colour is expected to be an array of four floats (rgba)
 		static void DrawCube(const glm::vec3& p0, float size, const glm::vec4& colour = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
 		static void DrawCube(float *p0, float size = 1.0f, float *colour = nullptr);
@@ -15,6 +15,7 @@
 #include "Sphere.h"
 #include "Cube.h"
 #include "../Logging.h"
+#include "../ShaderCache.h"
 
 
 TTK::Impl::MeshHelper::~MeshHelper() {
@@ -28,114 +29,145 @@ TTK::Impl::MeshHelper::~MeshHelper() {
 }
 
 void TTK::Impl::MeshHelper::RenderTeapot(const glm::mat4& transform, const glm::vec4& color) const {
-	glUseProgram(m_Shader);
-	glm::mat4 t = Context::Instance().GetViewProjection() * transform;
-	glProgramUniformMatrix4fv(m_Shader, 0, 1, FALSE, &t[0][0]);
-	glProgramUniform4fv(m_Shader, 1, 1, &color[0]);
-	glBindVertexArray(m_Teapot.VAO);
-	glDrawArrays(GL_TRIANGLES, 0, sizeof(TeapotData) / (sizeof(float) * 6));
+	Instance instance{ transform, color };
+	__Draw(m_Teapot, &instance, 1, Context::Instance().GetViewProjection());
 }
 
 void TTK::Impl::MeshHelper::RenderSphere(const glm::mat4& transform, const glm::vec4& color) const {
-	glUseProgram(m_Shader);
-	glm::mat4 t = Context::Instance().GetViewProjection() * transform;
-	glProgramUniformMatrix4fv(m_Shader, 0, 1, FALSE, &t[0][0]);
-	glProgramUniform4fv(m_Shader, 1, 1, &color[0]);
-	glBindVertexArray(m_Sphere.VAO);
-	glDrawArrays(GL_TRIANGLES, 0, sizeof(SphereData) / (sizeof(float) * 6));
+	Instance instance{ transform, color };
+	__Draw(m_Sphere, &instance, 1, Context::Instance().GetViewProjection());
 }
 
 void TTK::Impl::MeshHelper::RenderCube(const glm::mat4& transform, const glm::vec4& color) const
 {
-	glUseProgram(m_Shader);
-	glm::mat4 t = Context::Instance().GetViewProjection() * transform;
-	glProgramUniformMatrix4fv(m_Shader, 0, 1, FALSE, &t[0][0]);
-	glProgramUniform4fv(m_Shader, 1, 1, &color[0]);
-	glBindVertexArray(m_Cube.VAO);
-	glDrawArrays(GL_TRIANGLES, 0, sizeof(CubeData) / (sizeof(float) * 6));
+	Instance instance{ transform, color };
+	__Draw(m_Cube, &instance, 1, Context::Instance().GetViewProjection());
+}
+
+void TTK::Impl::MeshHelper::Flush(const glm::mat4& viewProjection) {
+	for (mesh* target : { &m_Teapot, &m_Sphere, &m_Cube }) {
+		__Draw(*target, target->Instances.data(), target->Instances.size(), viewProjection);
+		target->Instances.clear();
+	}
+}
+
+void TTK::Impl::MeshHelper::__Draw(const mesh& target, const Instance* instances, size_t count, const glm::mat4& viewProjection) const {
+	if (count > 0) {
+		size_t offset = m_Stream.Upload(instances, count * sizeof(Instance));
+		glVertexArrayVertexBuffer(target.VAO, 1, m_Stream.GetHandle(), offset, sizeof(Instance));
+
+		glUseProgram(m_Shader);
+		glProgramUniformMatrix4fv(m_Shader, 0, 1, GL_FALSE, &viewProjection[0][0]);
+		glBindVertexArray(target.VAO);
+		glDrawArraysInstanced(GL_TRIANGLES, 0, target.VertexCount, (GLsizei)count);
+	}
 }
 
 TTK::Impl::MeshHelper::mesh TTK::Impl::MeshHelper::__MakeMesh(const float* data, size_t size) const {
 	mesh result;
-	glCreateVertexArrays(1, &result.VAO);
-	glBindVertexArray(result.VAO);
+	result.VertexCount = (GLsizei)(size / (sizeof(float) * 6));
 	glCreateBuffers(1, &result.VBO);
-	glBindBuffer(GL_ARRAY_BUFFER, result.VBO);
-	glNamedBufferData(result.VBO, size, data, GL_DYNAMIC_DRAW);
-	glEnableVertexAttribArray(0);
-	glVertexAttribPointer(0, 3, GL_FLOAT, false, sizeof(float) * 6, 0);
+	glNamedBufferData(result.VBO, size, data, GL_STATIC_DRAW);
+
+	// binding 0 is the mesh itself (positions followed by normals, which we don't use)
+	glCreateVertexArrays(1, &result.VAO);
+	glVertexArrayVertexBuffer(result.VAO, 0, result.VBO, 0, sizeof(float) * 6);
+	glEnableVertexArrayAttrib(result.VAO, 0);
+	glVertexArrayAttribFormat(result.VAO, 0, 3, GL_FLOAT, false, 0);
+	glVertexArrayAttribBinding(result.VAO, 0, 0);
+
+	// binding 1 steps once per instance, and is pointed at the stream buffer when drawing. The transform takes
+	// up attributes 1 to 4, a column each, and the colour is attribute 5
+	glVertexArrayBindingDivisor(result.VAO, 1, 1);
+	for (GLuint column = 0; column < 4; column++) {
+		glEnableVertexArrayAttrib(result.VAO, 1 + column);
+		glVertexArrayAttribFormat(result.VAO, 1 + column, 4, GL_FLOAT, false, offsetof(Instance, Transform) + sizeof(glm::vec4) * column);
+		glVertexArrayAttribBinding(result.VAO, 1 + column, 1);
+	}
+	glEnableVertexArrayAttrib(result.VAO, 5);
+	glVertexArrayAttribFormat(result.VAO, 5, 4, GL_FLOAT, false, offsetof(Instance, Color));
+	glVertexArrayAttribBinding(result.VAO, 5, 1);
 	return result;
 }
 
-TTK::Impl::MeshHelper::MeshHelper()
+TTK::Impl::MeshHelper::MeshHelper(StreamBuffer& stream) :
+	m_Stream(stream)
 {
 	m_Teapot = __MakeMesh(TeapotData, sizeof(TeapotData));
 	m_Sphere = __MakeMesh(SphereData, sizeof(SphereData));
 	m_Cube   = __MakeMesh(CubeData, sizeof(CubeData));
 	
-	glBindVertexArray(0);
-	
 	const char* vsSource = R"LIT(#version 430
             layout (location = 0) in vec3 vertexPosition;
-            layout (location = 0) uniform mat4 xTransform;	
+            layout (location = 1) in mat4 instanceTransform;
+            layout (location = 5) in vec4 instanceColor;
+            layout (location = 0) uniform mat4 xViewProjection;
+
+            layout (location = 0) out vec4 fragmentColor;
             void main() {
-                gl_Position = xTransform * vec4(vertexPosition, 1);
+                gl_Position = xViewProjection * instanceTransform * vec4(vertexPosition, 1);
+                fragmentColor = instanceColor;
             })LIT";
 
 	const char* fsSource = R"LIT(#version 430   
-            layout (location = 1) uniform vec4 xColor;		
+            layout (location = 0) in vec4 fragmentColor;
             out vec4 frag_color;            	
             void main() {
-                frag_color = xColor;
+                frag_color = fragmentColor;
             })LIT";
 
 	m_Shader = glCreateProgram();
 
-	GLuint programs[2];
-	programs[0] = glCreateShader(GL_VERTEX_SHADER);
-	glShaderSource(programs[0], 1, &vsSource, NULL);
-	glCompileShader(programs[0]);
-	programs[1] = glCreateShader(GL_FRAGMENT_SHADER);
-	glShaderSource(programs[1], 1, &fsSource, NULL);
-	glCompileShader(programs[1]);
-
-	// Attach our two shaders
-	glAttachShader(m_Shader, programs[0]);
-	glAttachShader(m_Shader, programs[1]);
-
-	// Perform linking
-	glLinkProgram(m_Shader);
-
-	GLint success = 0;
-	glGetProgramiv(m_Shader, GL_LINK_STATUS, &success);
-	LOG_INFO("Status: {}", success);
-
-	if (success == GL_FALSE) {
-		// Get the length of the log
-		GLint length = 0;
-		glGetProgramiv(m_Shader, GL_INFO_LOG_LENGTH, &length);
-
-		if (length > 0) {
-			// Read the log from openGL
-			char* log = new char[length];
-			glGetProgramInfoLog(m_Shader, length, &length, log);
-			LOG_ERROR("Shader failed to link:\n{}", log);
-			delete[] log;
-		}
-		else {
-			LOG_ERROR("Shader failed to link for an unknown reason!");
+	// Programs that were linked on an earlier launch come straight from the cache
+	if (!ShaderCache::Load(m_Shader, vsSource, fsSource)) {
+		GLuint programs[2];
+		programs[0] = glCreateShader(GL_VERTEX_SHADER);
+		glShaderSource(programs[0], 1, &vsSource, NULL);
+		glCompileShader(programs[0]);
+		programs[1] = glCreateShader(GL_FRAGMENT_SHADER);
+		glShaderSource(programs[1], 1, &fsSource, NULL);
+		glCompileShader(programs[1]);
+
+		// Attach our two shaders
+		glAttachShader(m_Shader, programs[0]);
+		glAttachShader(m_Shader, programs[1]);
+
+		// Perform linking
+		glLinkProgram(m_Shader);
+
+		GLint success = 0;
+		glGetProgramiv(m_Shader, GL_LINK_STATUS, &success);
+		LOG_INFO("Status: {}", success);
+
+		if (success == GL_FALSE) {
+			// Get the length of the log
+			GLint length = 0;
+			glGetProgramiv(m_Shader, GL_INFO_LOG_LENGTH, &length);
+
+			if (length > 0) {
+				// Read the log from openGL
+				char* log = new char[length];
+				glGetProgramInfoLog(m_Shader, length, &length, log);
+				LOG_ERROR("Shader failed to link:\n{}", log);
+				delete[] log;
+			}
+			else {
+				LOG_ERROR("Shader failed to link for an unknown reason!");
+			}
+
+			// Delete the partial program
+			glDeleteProgram(m_Shader);
+
+			// Throw a runtime exception
+			throw new std::runtime_error("Failed to link shader program!");
 		}
 
-		// Delete the partial program
-		glDeleteProgram(m_Shader);
+		// Remove shader parts to save space
+		glDetachShader(m_Shader, programs[0]);
+		glDeleteShader(programs[0]);
+		glDetachShader(m_Shader, programs[1]);
+		glDeleteShader(programs[1]);
 
-		// Throw a runtime exception
-		throw new std::runtime_error("Failed to link shader program!");
+		ShaderCache::Store(m_Shader, vsSource, fsSource);
 	}
-
-	// Remove shader parts to save space
-	glDetachShader(m_Shader, programs[0]);
-	glDeleteShader(programs[0]);
-	glDetachShader(m_Shader, programs[1]);
-	glDeleteShader(programs[1]);
 }
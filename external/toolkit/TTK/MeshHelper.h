@@ -14,28 +14,49 @@
 #pragma once
 
 #include "TTKContext.h"
+#include <vector>
 
 namespace TTK {
 	namespace Impl {
 		class MeshHelper {			
 		public:
 			~MeshHelper();
-			MeshHelper();
+			// Instance data goes through stream, which has to outlive the helper
+			MeshHelper(StreamBuffer& stream);
+
+			// Draws a single object straight away
 			void RenderTeapot(const glm::mat4& transform, const glm::vec4& color) const;
 			void RenderSphere(const glm::mat4& transform, const glm::vec4& color) const;
 			void RenderCube(const glm::mat4& transform, const glm::vec4& color) const;
+
+			// Queues an object up to be drawn by the next Flush
+			void AddTeapot(const glm::mat4& transform, const glm::vec4& color) { m_Teapot.Instances.push_back({ transform, color }); }
+			void AddSphere(const glm::mat4& transform, const glm::vec4& color) { m_Sphere.Instances.push_back({ transform, color }); }
+			void AddCube(const glm::mat4& transform, const glm::vec4& color) { m_Cube.Instances.push_back({ transform, color }); }
+
+			// Draws everything queued since the last flush, with one instanced draw call for each mesh
+			void Flush(const glm::mat4& viewProjection);
 			
 		private:
+			// What each copy of a mesh is drawn with, read per instance from binding 1
+			struct Instance {
+				glm::mat4 Transform;
+				glm::vec4 Color;
+			};
 			struct mesh {
 				GLuint VAO;
 				GLuint VBO;
+				GLsizei VertexCount;
+				std::vector<Instance> Instances; // queued for the next flush
 			};
 			mesh __MakeMesh(const float* data, size_t size) const;
+			void __Draw(const mesh& target, const Instance* instances, size_t count, const glm::mat4& viewProjection) const;
 			
 			mesh m_Teapot;
 			mesh m_Sphere;
 			mesh m_Cube;
 			GLuint m_Shader;
+			StreamBuffer& m_Stream;
 		};
 	}
 }
\ No newline at end of file
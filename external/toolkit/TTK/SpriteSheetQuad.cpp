@@ -16,6 +16,7 @@
 
 #include <glad/glad.h>
 #include "../Logging.h"
+#include "../ShaderCache.h"
 
 TTK::SpriteSheetQuad::SpriteSheetQuad()
 {
@@ -75,26 +76,31 @@ TTK::SpriteSheetQuad::SpriteSheetQuad()
 
 	m_Shader = glCreateProgram();
 
-	GLuint programs[2];
-	programs[0] = glCreateShader(GL_VERTEX_SHADER);
-	glShaderSource(programs[0], 1, &vsSource, NULL);
-	glCompileShader(programs[0]);
-	programs[1] = glCreateShader(GL_FRAGMENT_SHADER);
-	glShaderSource(programs[1], 1, &fsSource, NULL);
-	glCompileShader(programs[1]);
-
-	// Attach our two shaders
-	glAttachShader(m_Shader, programs[0]);
-	glAttachShader(m_Shader, programs[1]);
-
-	// Perform linking
-	glLinkProgram(m_Shader);
-
-	// Remove shader parts to save space
-	glDetachShader(m_Shader, programs[0]);
-	glDeleteShader(programs[0]);
-	glDetachShader(m_Shader, programs[1]);
-	glDeleteShader(programs[1]);
+	// Programs that were linked on an earlier launch come straight from the cache
+	if (!ShaderCache::Load(m_Shader, vsSource, fsSource)) {
+		GLuint programs[2];
+		programs[0] = glCreateShader(GL_VERTEX_SHADER);
+		glShaderSource(programs[0], 1, &vsSource, NULL);
+		glCompileShader(programs[0]);
+		programs[1] = glCreateShader(GL_FRAGMENT_SHADER);
+		glShaderSource(programs[1], 1, &fsSource, NULL);
+		glCompileShader(programs[1]);
+
+		// Attach our two shaders
+		glAttachShader(m_Shader, programs[0]);
+		glAttachShader(m_Shader, programs[1]);
+
+		// Perform linking
+		glLinkProgram(m_Shader);
+
+		// Remove shader parts to save space
+		glDetachShader(m_Shader, programs[0]);
+		glDeleteShader(programs[0]);
+		glDetachShader(m_Shader, programs[1]);
+		glDeleteShader(programs[1]);
+
+		ShaderCache::Store(m_Shader, vsSource, fsSource);
+	}
 }
 
 void TTK::SpriteSheetQuad::SliceSpriteSheet(const char* fileName, float spriteSizeX, float spriteSizeY,
@@ -0,0 +1,107 @@
+//////////////////////////////////////////////////////////////////////////
+//
+// This file is a part of the Tutorial Tool Kit (TTK) library. 
+// You may not use this file in your GDW games.
+//
+// This file implements the streaming vertex ring
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "StreamBuffer.h"
+#include <cstring>
+#include "../Logging.h"
+
+namespace {
+	// Uploads start on this boundary, which covers the alignment of any vertex attribute
+	const size_t Alignment = 16;
+
+	const GLbitfield MapFlags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+}
+
+TTK::StreamBuffer::StreamBuffer(size_t regionSize) :
+	m_Buffer(0),
+	m_Mapped(nullptr),
+	m_RegionSize(0),
+	m_Region(0),
+	m_Offset(0),
+	m_Fences()
+{
+	__Create(regionSize);
+}
+
+TTK::StreamBuffer::~StreamBuffer() {
+	__Destroy();
+}
+
+size_t TTK::StreamBuffer::Upload(const void* data, size_t size) {
+	size_t offset = (m_Offset + Alignment - 1) & ~(Alignment - 1);
+
+	if (offset + size > m_RegionSize) {
+		// if the next region is still being read, this frame has more in flight than the whole ring holds, and
+		// waiting on it would stall every frame like this one. Growing means the next frame fits
+		if (size > m_RegionSize || !__NextRegion()) {
+			__Grow(size);
+		}
+		offset = 0;
+	}
+
+	size_t position = m_Region * m_RegionSize + offset;
+	memcpy(m_Mapped + position, data, size);
+	m_Offset = offset + size;
+	return position;
+}
+
+bool TTK::StreamBuffer::__NextRegion() {
+	// everything drawn from this region so far was issued before the fence, so it signals once they are all done
+	m_Fences[m_Region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+	m_Region = (m_Region + 1) % RegionCount;
+	m_Offset = 0;
+
+	GLsync fence = m_Fences[m_Region];
+	if (fence != nullptr) {
+		if (glClientWaitSync(fence, 0, 0) == GL_TIMEOUT_EXPIRED) {
+			return false;
+		}
+		glDeleteSync(fence);
+		m_Fences[m_Region] = nullptr;
+	}
+	return true;
+}
+
+void TTK::StreamBuffer::__Grow(size_t size) {
+	// double until it fits, so a frame that keeps getting busier only grows a handful of times
+	size_t regionSize = m_RegionSize * 2;
+	while (regionSize < size) {
+		regionSize *= 2;
+	}
+	LOG_INFO("TTK stream buffer grown to {} bytes a region", regionSize);
+	__Create(regionSize);
+}
+
+void TTK::StreamBuffer::__Create(size_t regionSize) {
+	__Destroy();
+
+	m_RegionSize = (regionSize + Alignment - 1) & ~(Alignment - 1);
+	m_Region = 0;
+	m_Offset = 0;
+
+	glCreateBuffers(1, &m_Buffer);
+	glNamedBufferStorage(m_Buffer, m_RegionSize * RegionCount, nullptr, MapFlags);
+	m_Mapped = (uint8_t*)glMapNamedBufferRange(m_Buffer, 0, m_RegionSize * RegionCount, MapFlags);
+}
+
+void TTK::StreamBuffer::__Destroy() {
+	for (GLsync& fence : m_Fences) {
+		if (fence != nullptr) {
+			glDeleteSync(fence);
+			fence = nullptr;
+		}
+	}
+	if (m_Buffer != 0) {
+		glUnmapNamedBuffer(m_Buffer);
+		glDeleteBuffers(1, &m_Buffer);
+		m_Buffer = 0;
+		m_Mapped = nullptr;
+	}
+}
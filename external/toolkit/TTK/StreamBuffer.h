@@ -0,0 +1,56 @@
+//////////////////////////////////////////////////////////////////////////
+//
+// This header is a part of the Tutorial Tool Kit (TTK) library. 
+// You may not use this header in your GDW games.
+//
+// This header contains a ring of GPU memory for streaming vertices that
+// change every frame, used by the Context for its batched primitives
+//
+//////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+
+namespace TTK
+{
+	// One buffer that stays mapped for its whole life (GL_MAP_PERSISTENT_BIT), split into three regions. Uploads
+	// are written straight into the mapping, one after another through the current region. When a region is full
+	// a fence goes in behind the draws that read from it, and we move on to the next one. Nothing ever writes to
+	// memory the GPU might be reading, so the driver never has to sync behind our back.
+	// The ring grows instead of waiting: when an upload is bigger than a region, or the GPU is still reading the
+	// next region (a frame filled the whole ring), the regions are doubled. The old buffer is deleted straight away,
+	// GL keeps it alive until the draws that use it are done
+	class StreamBuffer {
+	public:
+		static const int RegionCount = 3;
+
+		// regionSize is the number of bytes in each of the three regions to begin with
+		StreamBuffer(size_t regionSize = 64 * 1024);
+		~StreamBuffer();
+
+		StreamBuffer(const StreamBuffer&) = delete;
+		StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+		// Copies size bytes into the ring, and returns the offset they are at in GetHandle(). The handle changes
+		// when the ring grows, so only get it after uploading
+		size_t Upload(const void* data, size_t size);
+
+		GLuint GetHandle() const { return m_Buffer; }
+		size_t GetRegionSize() const { return m_RegionSize; }
+
+	private:
+		void __Create(size_t regionSize); // (re)creates and maps the buffer, forgetting every fence
+		void __Destroy();
+		bool __NextRegion(); // fences the current region and moves to the next, false if the GPU is still reading it
+		void __Grow(size_t size); // doubles the regions until size fits in one
+
+		GLuint   m_Buffer;
+		uint8_t* m_Mapped;
+		size_t   m_RegionSize;
+		int      m_Region; // region we are writing into
+		size_t   m_Offset; // bytes used in the current region
+		GLsync   m_Fences[RegionCount]; // signalled once the GPU is done reading a region, null if it never was
+	};
+}
@@ -14,6 +14,8 @@
 #include <GLM/gtc/matrix_transform.hpp>
 #include <string>
 #include "../Logging.h"
+#include "../ShaderCache.h"
+#include "../Trace.h"
 #include "MeshHelper.h"
 
 TTK::Context* TTK::Context::m_Instance = nullptr;
@@ -21,9 +23,6 @@ TTK::Context* TTK::Context::m_Instance = nullptr;
 TTK::Context::~Context() {
 	delete m_MeshHelper;
 	delete m_DefaultFont;
-	glDeleteBuffers(1, &m_Tris.VBO);
-	glDeleteBuffers(1, &m_Lines.VBO);
-	glDeleteBuffers(1, &m_Points.VBO);
 	glDeleteVertexArrays(1, &m_Tris.VAO);
 	glDeleteVertexArrays(1, &m_Lines.VAO);
 	glDeleteVertexArrays(1, &m_Points.VAO);
@@ -43,6 +42,7 @@ void TTK::Context::SetWindowSize(int windowWidth, int windowHeight) {
 
 void TTK::Context::RenderText(const char* text, const glm::vec2& position, const glm::vec4& color, float scale) {
 	TTK::FontRenderer::Instance().Render(*m_DefaultFont, text, position, color, scale);
+	m_TextPending = true;
 }
 
 void TTK::Context::DrawTeapot(const glm::mat4& mat, const glm::vec4& color) const {
@@ -57,28 +57,27 @@ void TTK::Context::DrawCube(const glm::mat4& mat, const glm::vec4& color) const
 	m_MeshHelper->RenderCube(mat, color);
 }
 
+void TTK::Context::AddTeapot(const glm::mat4& mat, const glm::vec4& color) {
+	m_MeshHelper->AddTeapot(mat, color);
+}
+
+void TTK::Context::AddSphere(const glm::mat4& mat, const glm::vec4& color) {
+	m_MeshHelper->AddSphere(mat, color);
+}
+
+void TTK::Context::AddCube(const glm::mat4& mat, const glm::vec4& color) {
+	m_MeshHelper->AddCube(mat, color);
+}
+
 void TTK::Context::AddLine(const glm::vec3& a, const glm::vec3& b, const glm::vec4& color) {
-	m_LineVerts[m_Lines.Count + 0].Position = a;
-	m_LineVerts[m_Lines.Count + 0].Color = color;
-	m_LineVerts[m_Lines.Count + 1].Position = b;
-	m_LineVerts[m_Lines.Count + 1].Color = color;
-	m_Lines.Count += 2;
-	if (m_Lines.Count == MaxLineVerts) {
-		__Flush(m_Lines);
-	}
+	m_LineVerts.push_back({ a, color });
+	m_LineVerts.push_back({ b, color });
 }
 
 void TTK::Context::AddTri(const glm::vec3& a, const glm::vec3& b, const glm::vec3& c, const glm::vec4& color) {
-	m_TriVerts[m_Tris.Count + 0].Position = a;
-	m_TriVerts[m_Tris.Count + 0].Color = color;
-	m_TriVerts[m_Tris.Count + 1].Position = b;
-	m_TriVerts[m_Tris.Count + 1].Color = color;
-	m_TriVerts[m_Tris.Count + 2].Position = c;
-	m_TriVerts[m_Tris.Count + 2].Color = color;
-	m_Tris.Count += 3;
-	if (m_Tris.Count == MaxTriVerts) {
-		__Flush(m_Tris);
-	}
+	m_TriVerts.push_back({ a, color });
+	m_TriVerts.push_back({ b, color });
+	m_TriVerts.push_back({ c, color });
 }
 
 void TTK::Context::AddQuad(const glm::vec3& min, const glm::vec3& max, const glm::vec4& color) {
@@ -90,22 +89,32 @@ void TTK::Context::AddQuad(const glm::vec3& min, const glm::vec3& max, const glm
 
 void TTK::Context::AddPoint(const glm::vec3& pos, float size, const glm::vec4& color)
 {
-	m_PointVerts[m_Points.Count].Position = pos;
-	m_PointVerts[m_Points.Count].Color = color;
-	m_PointVerts[m_Points.Count].Size = size;
-	m_Points.Count += 1;
-	if (m_Points.Count == MaxPointVerts) {
-		__Flush(m_Points);
-	}
+	m_PointVerts.push_back({ pos, color, size });
 }
 
 void TTK::Context::Flush() {
-	__Flush(m_Tris);
-	__Flush(m_Lines);
-	__Flush(m_Points);
+	TRACE_SCOPE("TTK::Context::Flush");
+	m_MeshHelper->Flush(m_ViewProjection);
+	__Flush(m_Tris, m_TriVerts.data(), m_TriVerts.size());
+	__Flush(m_Lines, m_LineVerts.data(), m_LineVerts.size());
+	__Flush(m_Points, m_PointVerts.data(), m_PointVerts.size());
+	m_TriVerts.clear();
+	m_LineVerts.clear();
+	m_PointVerts.clear();
+
+	// text goes on top of everything else
+	if (m_TextPending) {
+		TTK::FontRenderer::Instance().Flush();
+		m_TextPending = false;
+	}
 }
 
 TTK::Context::Context() {
+	m_PointVerts.reserve(InitialPointVerts);
+	m_LineVerts.reserve(InitialLineVerts);
+	m_TriVerts.reserve(InitialTriVerts);
+	m_TextPending = false;
+
 	m_Projection = glm::ortho(0.0f, 800.0f, 0.0f, 600.0f);
 	m_ViewMatrix = glm::mat4(1.0f);
 	m_DefaultFont = new TrueTypeTextureFont("C:\\\\Windows\\Fonts\\consola.ttf", 32);
@@ -148,61 +157,57 @@ TTK::Context::Context() {
 	m_PointShaderHandle = __CompileShader(vsSourcePoint, fsSource);
 
 
-	m_Tris = __InitBuff(GL_TRIANGLES, m_ShaderHandle, m_TriVerts, sizeof(SimpleVert), MaxTriVerts);
-	glEnableVertexAttribArray(0);
-	glEnableVertexAttribArray(1);
-	glVertexAttribPointer(0, 3, GL_FLOAT, false, sizeof(SimpleVert), (void*)offsetof(SimpleVert, Position));
-	glVertexAttribPointer(1, 4, GL_FLOAT, false, sizeof(SimpleVert), (void*)offsetof(SimpleVert, Color));
-
-	m_Lines = __InitBuff(GL_LINES, m_ShaderHandle, m_LineVerts, sizeof(SimpleVert), MaxLineVerts);
-	glEnableVertexAttribArray(0);
-	glEnableVertexAttribArray(1);
-	glVertexAttribPointer(0, 3, GL_FLOAT, false, sizeof(SimpleVert), (void*)offsetof(SimpleVert, Position));
-	glVertexAttribPointer(1, 4, GL_FLOAT, false, sizeof(SimpleVert), (void*)offsetof(SimpleVert, Color));
+	// the vertex layouts only say how to read binding 0, which is pointed at wherever each flush's vertices went in
+	// the stream buffer
+	m_Tris = __InitBuff(GL_TRIANGLES, m_ShaderHandle, sizeof(SimpleVert));
+	glVertexArrayAttribFormat(m_Tris.VAO, 0, 3, GL_FLOAT, false, offsetof(SimpleVert, Position));
+	glVertexArrayAttribFormat(m_Tris.VAO, 1, 4, GL_FLOAT, false, offsetof(SimpleVert, Color));
 
-	m_Points = __InitBuff(GL_POINTS, m_PointShaderHandle, m_PointVerts, sizeof(PointVert), MaxLineVerts);
-	glEnableVertexAttribArray(0);
-	glEnableVertexAttribArray(1);
-	glEnableVertexAttribArray(2);
-	glVertexAttribPointer(0, 3, GL_FLOAT, false, sizeof(PointVert), (void*)offsetof(PointVert, Position));
-	glVertexAttribPointer(1, 4, GL_FLOAT, false, sizeof(PointVert), (void*)offsetof(PointVert, Color));
-	glVertexAttribPointer(2, 1, GL_FLOAT, false, sizeof(PointVert), (void*)offsetof(PointVert, Size));
+	m_Lines = __InitBuff(GL_LINES, m_ShaderHandle, sizeof(SimpleVert));
+	glVertexArrayAttribFormat(m_Lines.VAO, 0, 3, GL_FLOAT, false, offsetof(SimpleVert, Position));
+	glVertexArrayAttribFormat(m_Lines.VAO, 1, 4, GL_FLOAT, false, offsetof(SimpleVert, Color));
 
-	glBindVertexArray(0);
+	m_Points = __InitBuff(GL_POINTS, m_PointShaderHandle, sizeof(PointVert));
+	glVertexArrayAttribFormat(m_Points.VAO, 0, 3, GL_FLOAT, false, offsetof(PointVert, Position));
+	glVertexArrayAttribFormat(m_Points.VAO, 1, 4, GL_FLOAT, false, offsetof(PointVert, Color));
+	glEnableVertexArrayAttrib(m_Points.VAO, 2);
+	glVertexArrayAttribFormat(m_Points.VAO, 2, 1, GL_FLOAT, false, offsetof(PointVert, Size));
+	glVertexArrayAttribBinding(m_Points.VAO, 2, 0);
 
 	// Make sure that the mesh helper has a context
-	m_MeshHelper = new Impl::MeshHelper();
+	m_MeshHelper = new Impl::MeshHelper(m_Stream);
 
 	// Allow our shaders to specify a point size
 	glEnable(GL_PROGRAM_POINT_SIZE);
 }
 
-TTK::Context::GLBuff TTK::Context::__InitBuff(GLenum mode, GLuint shader, void* dataSource, size_t elemSize, size_t maxElems)
+TTK::Context::GLBuff TTK::Context::__InitBuff(GLenum mode, GLuint shader, size_t elemSize)
 {
 	GLBuff result;
 	result.Mode = mode;
-	result.Count = 0;
-	result.Data = dataSource;
 	result.ElemSize = elemSize;
 	result.Shader = shader;
 
+	// every layout has a position and a colour in attributes 0 and 1, anything else is added by the caller
 	glCreateVertexArrays(1, &result.VAO);
-	glBindVertexArray(result.VAO);
-	glCreateBuffers(1, &result.VBO);
-	glBindBuffer(GL_ARRAY_BUFFER, result.VBO);
-	glNamedBufferData(result.VBO, elemSize * maxElems, nullptr, GL_STREAM_DRAW);
+	for (GLuint attrib = 0; attrib < 2; attrib++) {
+		glEnableVertexArrayAttrib(result.VAO, attrib);
+		glVertexArrayAttribBinding(result.VAO, attrib, 0);
+	}
 
 	return result;
 }
 
-void TTK::Context::__Flush(GLBuff& buff) {
-	if (buff.Count > 0) {
+void TTK::Context::__Flush(GLBuff& buff, const void* data, size_t count) {
+	if (count > 0) {
+		// straight into mapped memory the GPU isn't reading, so neither the copy nor the draw waits on anything
+		size_t offset = m_Stream.Upload(data, count * buff.ElemSize);
+		glVertexArrayVertexBuffer(buff.VAO, 0, m_Stream.GetHandle(), offset, (GLsizei)buff.ElemSize);
+
 		glUseProgram(buff.Shader);
 		glUniformMatrix4fv(0, 1, false, &m_ViewProjection[0][0]);
-		glNamedBufferSubData(buff.VBO, 0, buff.Count * buff.ElemSize, buff.Data);
 		glBindVertexArray(buff.VAO);
-		glDrawArrays(buff.Mode, 0, buff.Count);
-		buff.Count = 0;
+		glDrawArrays(buff.Mode, 0, (GLsizei)count);
 	}
 }
 
@@ -210,6 +215,11 @@ GLuint TTK::Context::__CompileShader(const char* vsSource, const char* fsSource)
 {
 	GLuint result = glCreateProgram();
 
+	// Programs that were linked on an earlier launch come straight from the cache
+	if (ShaderCache::Load(result, vsSource, fsSource)) {
+		return result;
+	}
+
 	GLuint programs[2];
 	programs[0] = glCreateShader(GL_VERTEX_SHADER);
 	glShaderSource(programs[0], 1, &vsSource, NULL);
@@ -258,5 +268,6 @@ GLuint TTK::Context::__CompileShader(const char* vsSource, const char* fsSource)
 	glDetachShader(result, programs[1]);
 	glDeleteShader(programs[1]);
 
+	ShaderCache::Store(result, vsSource, fsSource);
 	return result;
 }
@@ -14,7 +14,9 @@
 #pragma once
 
 #include <GLM/glm.hpp>
+#include <vector>
 #include "FontRenderer.h"
+#include "StreamBuffer.h"
 
 namespace TTK
 {
@@ -63,17 +65,26 @@ namespace TTK
 		
 		void SetWindowSize(int windowWidth, int windowHeight);
 
+		// Text is drawn by the next flush, on top of everything else
 		void RenderText(const char* text, const glm::vec2& position, const glm::vec4& color, float scale = 1.0f);
 		
+		// Draw a mesh straight away, with a draw call each. Use the Add versions below for more than a handful
 		void DrawTeapot(const glm::mat4& mat, const glm::vec4& color = glm::vec4(1.0f)) const;
 		void DrawSphere(const glm::mat4& mat, const glm::vec4& color = glm::vec4(1.0f)) const;
 		void DrawCube(const glm::mat4& mat, const glm::vec4& color = glm::vec4(1.0f)) const;
 
+		// Queue a mesh up for the next flush, where every copy of it is drawn with one instanced draw call
+		void AddTeapot(const glm::mat4& mat, const glm::vec4& color = glm::vec4(1.0f));
+		void AddSphere(const glm::mat4& mat, const glm::vec4& color = glm::vec4(1.0f));
+		void AddCube(const glm::mat4& mat, const glm::vec4& color = glm::vec4(1.0f));
+
 		void AddLine(const glm::vec3& a, const glm::vec3& b, const glm::vec4& color = {0, 0, 0, 1});
 		void AddTri(const glm::vec3& a, const glm::vec3& b, const glm::vec3& c, const glm::vec4& color = { 0, 0, 0, 1 });
 		void AddQuad(const glm::vec3& min, const glm::vec3& max, const glm::vec4& color = { 0, 0, 0, 1 });
 		void AddPoint(const glm::vec3& pos, float size, const glm::vec4& color = { 0, 0, 0, 1 });
 		
+		// Draws everything added since the last flush, as one upload and one draw call for each kind of primitive and
+		// each mesh. There is no limit on how much can be added in between, call it once a frame
 		void Flush();
 
 	private:
@@ -82,32 +93,34 @@ namespace TTK
 		glm::mat4                 m_ViewMatrix;
 		glm::mat4                 m_ViewProjection;
 		TTK::TrueTypeTextureFont* m_DefaultFont;
+		bool                      m_TextPending; // whether text has been rendered since the last flush
 		Impl::MeshHelper*         m_MeshHelper;
 
 		GLuint m_ShaderHandle;
 		GLuint m_PointShaderHandle;
 		struct GLBuff {
-			GLuint VBO, VAO;
-			size_t Count;
+			GLuint VAO;
 			size_t ElemSize;
 			GLenum Mode;
-			void*  Data;
 			GLuint Shader;
 		};
 		GLBuff m_Tris, m_Lines, m_Points;
 
 		float m_WindowWidth, m_WindowHeight;
 
-		GLBuff __InitBuff(GLenum mode, GLuint shader, void* dataSource, size_t elemSize, size_t maxElems);
-		void __Flush(GLBuff& buff);
+		GLBuff __InitBuff(GLenum mode, GLuint shader, size_t elemSize);
+		void __Flush(GLBuff& buff, const void* data, size_t count);
 		GLuint __CompileShader(const char* vsSource, const char* fsSource);
 
-		static const size_t MaxPointVerts = 512;
-		static const size_t MaxLineVerts = 512 * 2;
-		static const size_t MaxTriVerts = 512 * 3;
+		// How many vertices of each kind there is room for before the vectors have to grow
+		static const size_t InitialPointVerts = 512;
+		static const size_t InitialLineVerts = 512 * 2;
+		static const size_t InitialTriVerts = 512 * 3;
 
-		PointVert  m_PointVerts[MaxPointVerts];
-		SimpleVert m_LineVerts[MaxLineVerts];
-		SimpleVert m_TriVerts[MaxTriVerts];
+		// Everything added since the last flush, uploaded through m_Stream when it comes
+		std::vector<PointVert>  m_PointVerts;
+		std::vector<SimpleVert> m_LineVerts;
+		std::vector<SimpleVert> m_TriVerts;
+		StreamBuffer            m_Stream;
 	};
 }
@@ -0,0 +1,146 @@
+#include "Trace.h"
+
+#ifdef ENABLE_TRACING
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+	using Clock = std::chrono::steady_clock;
+
+	// Timestamps are relative to when the program started, so they stay small
+	const Clock::time_point traceStart = Clock::now();
+
+	struct Event {
+		const char* name;
+		uint64_t nanoseconds;
+		char phase; // 'B' for begin, 'E' for end
+	};
+
+	// One thread's events. Only the owning thread writes, so the only thing that needs to be atomic is how many
+	// events have been written, which is what a dump uses to know which slots it can trust
+	struct ThreadBuffer {
+		std::vector<Event> events = std::vector<Event>(Trace::EVENTS_PER_THREAD);
+		std::atomic<uint64_t> written{ 0 };
+		std::atomic<const char*> name{ nullptr }; // set by the owning thread, read by dumps
+		uint32_t id = 0;
+	};
+
+	// Every thread that has ever traced. Threads only lock this the first time they trace, and buffers are kept
+	// alive here after their thread exits so their events still make it into the dump
+	std::mutex buffersLock;
+	std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+
+	ThreadBuffer& __GetThreadBuffer() {
+		thread_local std::shared_ptr<ThreadBuffer> buffer;
+		if (buffer == nullptr) {
+			buffer = std::make_shared<ThreadBuffer>();
+			std::lock_guard<std::mutex> lock(buffersLock);
+			buffer->id = (uint32_t)buffers.size() + 1;
+			buffers.push_back(buffer);
+		}
+		return *buffer;
+	}
+
+	void __Record(const char* name, char phase) {
+		uint64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - traceStart).count();
+
+		ThreadBuffer& buffer = __GetThreadBuffer();
+		uint64_t index = buffer.written.load(std::memory_order_relaxed);
+		buffer.events[index % Trace::EVENTS_PER_THREAD] = { name, now, phase };
+		buffer.written.store(index + 1, std::memory_order_release);
+	}
+
+	void __WriteString(FILE* file, const char* text) {
+		fputc('"', file);
+		for (const char* c = text; *c != '\0'; c++) {
+			if (*c == '"' || *c == '\\') {
+				fputc('\\', file);
+			}
+			fputc(*c, file);
+		}
+		fputc('"', file);
+	}
+}
+
+void Trace::Begin(const char* name) {
+	__Record(name, 'B');
+}
+
+void Trace::End() {
+	__Record("", 'E');
+}
+
+void Trace::SetThreadName(const char* name) {
+	__GetThreadBuffer().name = name;
+}
+
+bool Trace::Dump(const std::string& path) {
+	FILE* file = fopen(path.c_str(), "w");
+	if (file == nullptr) {
+		return false;
+	}
+
+	std::vector<std::shared_ptr<ThreadBuffer>> threads;
+	{
+		std::lock_guard<std::mutex> lock(buffersLock);
+		threads = buffers;
+	}
+
+	fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	bool first = true;
+	std::vector<Event> copy;
+
+	for (const std::shared_ptr<ThreadBuffer>& thread : threads) {
+		const char* name = thread->name.load();
+		if (name != nullptr) {
+			fprintf(file, "%s{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":", first ? "" : ",\n", thread->id);
+			__WriteString(file, name);
+			fprintf(file, "}}");
+			first = false;
+		}
+
+		// copy out what is there, then throw away anything the owning thread may have overwritten while we copied
+		uint64_t end = thread->written.load(std::memory_order_acquire);
+		uint64_t begin = end > EVENTS_PER_THREAD ? end - EVENTS_PER_THREAD : 0;
+		copy.clear();
+		for (uint64_t i = begin; i < end; i++) {
+			copy.push_back(thread->events[i % EVENTS_PER_THREAD]);
+		}
+		uint64_t after = thread->written.load(std::memory_order_acquire);
+		uint64_t safe = after > EVENTS_PER_THREAD ? after - EVENTS_PER_THREAD : 0;
+		size_t skip = safe > begin ? (size_t)(safe - begin) : 0;
+
+		// a ring that wrapped can start part way through a span, an end with nothing open would confuse the viewer
+		int depth = 0;
+		for (size_t i = skip; i < copy.size(); i++) {
+			const Event& e = copy[i];
+			if (e.phase == 'E') {
+				if (depth == 0) {
+					continue;
+				}
+				depth--;
+			}
+			else {
+				depth++;
+			}
+
+			fprintf(file, "%s{\"ph\":\"%c\",\"pid\":1,\"tid\":%u,\"ts\":%.3f", first ? "" : ",\n", e.phase, thread->id, e.nanoseconds / 1000.0);
+			if (e.phase == 'B') {
+				fprintf(file, ",\"name\":");
+				__WriteString(file, e.name);
+			}
+			fprintf(file, "}");
+			first = false;
+		}
+	}
+
+	fprintf(file, "\n]}\n");
+	return fclose(file) == 0;
+}
+
+#endif
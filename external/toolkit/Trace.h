@@ -0,0 +1,61 @@
+#pragma once
+
+/*
+	Records begin/end spans on every thread that uses it, and writes them out as a Chrome trace (trace.json) that can
+	be opened in chrome://tracing or ui.perfetto.dev to look at stutters after the fact.
+
+	Each thread writes into its own fixed size ring of events without taking any locks, so tracing a hot path costs
+	a clock read and a couple of stores. Once a ring is full the oldest events are overwritten, so a dump always holds
+	the most recent history.
+
+	Tracing only exists when ENABLE_TRACING is defined (premake --trace). Otherwise every TRACE_ macro compiles to
+	nothing, and so do the arguments passed to it (TRACE_DUMP just evaluates to false)
+*/
+
+#ifdef ENABLE_TRACING
+
+#include <cstddef>
+#include <string>
+
+class Trace {
+public:
+	// Number of events each thread keeps before it starts overwriting the oldest ones
+	static constexpr size_t EVENTS_PER_THREAD = 1 << 16;
+
+	// Opens a span on the calling thread. name is stored by pointer, so it must outlive the trace (a string literal)
+	static void Begin(const char* name);
+	// Closes the most recent span on the calling thread
+	static void End();
+
+	// Names the calling thread in the trace, the name must outlive the trace (a string literal)
+	static void SetThreadName(const char* name);
+
+	// Writes every thread's events out as a Chrome trace. Returns false if the file couldn't be written
+	static bool Dump(const std::string& path);
+
+	// Opens a span for as long as it is alive
+	class Scope {
+	public:
+		Scope(const char* name) { Begin(name); }
+		~Scope() { End(); }
+	};
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+#define TRACE_SCOPE(name) Trace::Scope TRACE_CONCAT(__traceScope, __COUNTER__)(name)
+#define TRACE_BEGIN(name) Trace::Begin(name)
+#define TRACE_END() Trace::End()
+#define TRACE_THREAD_NAME(name) Trace::SetThreadName(name)
+#define TRACE_DUMP(path) Trace::Dump(path)
+
+#else
+
+#define TRACE_SCOPE(name) ((void)0)
+#define TRACE_BEGIN(name) ((void)0)
+#define TRACE_END() ((void)0)
+#define TRACE_THREAD_NAME(name) ((void)0)
+#define TRACE_DUMP(path) (false)
+
+#endif
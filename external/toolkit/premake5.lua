@@ -16,24 +16,27 @@ project "Toolkit"
         "EnumToString.h",
         "Sys.h",
         "Sys.cpp",
-        "TTK\\**.cpp",
-        "TTK\\**.h"
+        "Trace.h",
+        "Trace.cpp",
+        "ShaderCache.h",
+        "ShaderCache.cpp",
+        "TTK/**.cpp",
+        "TTK/**.h"
     }
 
     links {
         "Glad",
         "GLFW",
-        "stbs",
-        "opengl32.lib"
+        "stbs"
     }
 
     includedirs {
-        "%{wks.location}\\external\\spdlog",
-        "%{wks.location}\\external\\GLM\\include",
-        "%{wks.location}\\external\\glad\\include",
-        "%{wks.location}\\external\\glfw3\\include",
-        "%{wks.location}\\external\\imgui",
-        "%{wks.location}\\external\\stbs"
+        "%{wks.location}/external/spdlog",
+        "%{wks.location}/external/GLM/include",
+        "%{wks.location}/external/glad/include",
+        "%{wks.location}/external/glfw3/include",
+        "%{wks.location}/external/imgui",
+        "%{wks.location}/external/stbs"
     }
 
     filter "system:windows"
@@ -44,6 +47,22 @@ project "Toolkit"
             "TTK_GLFW"
         }
 
+        links {
+            "opengl32.lib"
+        }
+
+    filter "system:linux"
+        defines {
+            "TTK_GLFW"
+        }
+
+        -- Everything goes through glad, with --osmesa there is no libGL to link
+        if not _OPTIONS["osmesa"] then
+            links {
+                "GL"
+            }
+        end
+
         
     filter "configurations:Debug"
         runtime "Debug"
@@ -0,0 +1,71 @@
+#include "Headless.h"
+#include "Logging.h"
+#include "SnakeSim.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// The sim with no window, GL or GLFW, for profiling and soak testing on machines without a display.
+//   --fast-forward <replay>...  check stored games, exits with the number that failed
+//   --episodes <count>          play random games on every core (1000 by default)
+//   --check-batch <count>       step that many SnakeBatch games next to SnakeSims for --max-ticks ticks, and exit with
+//                               the number that played out differently
+//   --threads <count>           worker threads for --episodes, 0 for one per hardware thread
+//   --max-ticks <count>         longest an episode can last
+//   --seed <number>             seed of the first episode, the rest follow on from it
+//   --board <width>x<height>    board size of every episode, 39x39 by default
+int main(int argc, char** argv) {
+	Logger::Init();
+
+	if (argc > 1 && strcmp(argv[1], "--fast-forward") == 0) {
+		int failed = FastForward(argc - 2, argv + 2);
+		Logger::Uninitialize();
+		return failed;
+	}
+
+	uint32_t episodes = 1000;
+	uint32_t checkGames = 0;
+	uint32_t threads = 0;
+	uint64_t maxTicks = 100000;
+	uint64_t seed = 1;
+	int width = SnakeSim::DEFAULT_SIZE, height = SnakeSim::DEFAULT_SIZE;
+	for (int i = 1; i + 1 < argc; i++) {
+		if (strcmp(argv[i], "--episodes") == 0) {
+			episodes = (uint32_t)strtoul(argv[i + 1], nullptr, 10);
+		}
+		else if (strcmp(argv[i], "--check-batch") == 0) {
+			checkGames = (uint32_t)strtoul(argv[i + 1], nullptr, 10);
+		}
+		else if (strcmp(argv[i], "--threads") == 0) {
+			threads = (uint32_t)strtoul(argv[i + 1], nullptr, 10);
+		}
+		else if (strcmp(argv[i], "--max-ticks") == 0) {
+			maxTicks = strtoull(argv[i + 1], nullptr, 10);
+		}
+		else if (strcmp(argv[i], "--seed") == 0) {
+			seed = strtoull(argv[i + 1], nullptr, 10);
+		}
+		else if (strcmp(argv[i], "--board") == 0) {
+			sscanf(argv[i + 1], "%dx%d", &width, &height);
+		}
+	}
+
+	int failed = 0;
+	try {
+		if (checkGames > 0) {
+			failed = CheckBatch(checkGames, maxTicks, seed, width, height);
+		}
+		else {
+			RunEpisodes(episodes, threads, maxTicks, seed, width, height);
+		}
+	}
+	catch (const std::exception& e) {
+		LOG_ERROR(e.what());
+		Logger::Uninitialize();
+		return 1;
+	}
+
+	Logger::Uninitialize();
+	return failed;
+}
@@ -0,0 +1,6 @@
+#!/bin/sh
+# Generates makefiles for Linux (premake5 needs to be on the PATH), then builds with e.g.
+#   make config=release_x64 -j$(nproc)
+# Pass --headless to only build the sim (no GL, GLFW or X11 needed), --sanitize=address|undefined|thread to build with
+# a sanitizer, --osmesa to build GLFW without X11 for --offscreen runs with no display, and --trace to record trace.json
+premake5 gmake2 "$@"
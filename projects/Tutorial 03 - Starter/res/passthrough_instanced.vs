@@ -0,0 +1,16 @@
+#version 410
+
+layout (location = 0) in vec3 inPosition;
+layout (location = 1) in vec4 inColor;
+
+// Per-instance attributes, these advance once per quad instead of once per vertex
+layout (location = 2) in vec2 inInstancePosition;
+layout (location = 3) in vec2 inInstanceSize;
+layout (location = 4) in vec4 inInstanceColor;
+
+layout (location = 0) out vec4 outColor;
+
+void main() {
+	outColor = inColor * inInstanceColor;
+	gl_Position = vec4(inPosition.xy * inInstanceSize + inInstancePosition, inPosition.z, 1);
+}
\ No newline at end of file
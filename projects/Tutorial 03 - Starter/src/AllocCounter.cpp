@@ -0,0 +1,67 @@
+#include "AllocCounter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#ifdef TRACK_ALLOCATIONS
+// Every thread keeps its own count so that counting doesn't need any locking, the total is shared
+static thread_local uint64_t threadAllocCount = 0;
+static std::atomic<uint64_t> totalAllocCount(0);
+
+// Replacements for the global allocation functions, these count the allocation and then defer to malloc/free
+void* operator new(std::size_t size) {
+	threadAllocCount++;
+	totalAllocCount.fetch_add(1, std::memory_order_relaxed);
+
+	void* result = malloc(size > 0 ? size : 1);
+	if (result == nullptr) {
+		throw std::bad_alloc();
+	}
+	return result;
+}
+
+void* operator new[](std::size_t size) {
+	return operator new(size);
+}
+
+void operator delete(void* ptr) noexcept {
+	free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+	free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+	free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept {
+	free(ptr);
+}
+#endif
+
+bool AllocCounter::IsEnabled() {
+#ifdef TRACK_ALLOCATIONS
+	return true;
+#else
+	return false;
+#endif
+}
+
+uint64_t AllocCounter::GetThreadCount() {
+#ifdef TRACK_ALLOCATIONS
+	return threadAllocCount;
+#else
+	return 0;
+#endif
+}
+
+uint64_t AllocCounter::GetTotalCount() {
+#ifdef TRACK_ALLOCATIONS
+	return totalAllocCount.load(std::memory_order_relaxed);
+#else
+	return 0;
+#endif
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+
+// Counts heap allocations made through operator new, so we can check that hot paths (like a sim tick) don't touch the
+// heap. Counting is only compiled in when TRACK_ALLOCATIONS is defined, otherwise every count is always 0
+class AllocCounter {
+public:
+	// Returns true if allocations are actually being counted in this build
+	static bool IsEnabled();
+
+	// Number of allocations made by the calling thread since it started
+	static uint64_t GetThreadCount();
+	// Number of allocations made by every thread since the program started
+	static uint64_t GetTotalCount();
+
+	// Counts the allocations the calling thread makes while this object is alive
+	class Scope {
+	public:
+		Scope() : myStart(GetThreadCount()) { }
+
+		// Number of allocations made since this scope was created
+		uint64_t GetCount() const { return GetThreadCount() - myStart; }
+
+	private:
+		uint64_t myStart;
+	};
+};
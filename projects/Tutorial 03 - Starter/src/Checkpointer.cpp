@@ -0,0 +1,101 @@
+#include "Checkpointer.h"
+#include "SnakeSim.h"
+
+#include <fstream>
+#include <utility>
+#include <cereal/archives/binary.hpp>
+
+Checkpointer::Checkpointer(uint32_t keyframeInterval, size_t maxCheckpoints) :
+	keyframeInterval(keyframeInterval > 0 ? keyframeInterval : 1),
+	maxCheckpoints(maxCheckpoints)
+{ }
+
+void Checkpointer::capture(const SnakeSim& sim, uint64_t tag)
+{
+	// once we are full, drop the oldest keyframe and every delta that depends on it
+	if (maxCheckpoints > 0 && tags.size() >= maxCheckpoints && tags.size() >= keyframeInterval) {
+		keyframes.erase(keyframes.begin());
+		deltas.erase(deltas.begin(), deltas.begin() + keyframeInterval);
+		tags.erase(tags.begin(), tags.begin() + keyframeInterval);
+	}
+
+	sim.saveSnapshot(scratch);
+
+	if (tags.size() % keyframeInterval == 0) {
+		keyframes.push_back(scratch);
+		deltas.emplace_back();
+	}
+	else {
+		deltas.emplace_back();
+		deltas.back().diff(latest, scratch);
+	}
+	tags.push_back(tag);
+
+	std::swap(latest, scratch);
+}
+
+void Checkpointer::restore(SnakeSim& sim, size_t index) const
+{
+	SimSnapshot state;
+	__Rebuild(index, state);
+	sim.restoreSnapshot(state);
+}
+
+void Checkpointer::rewind(SnakeSim& sim, size_t index)
+{
+	__Rebuild(index, latest);
+	sim.restoreSnapshot(latest);
+
+	keyframes.resize(index / keyframeInterval + 1);
+	deltas.resize(index + 1);
+	tags.resize(index + 1);
+}
+
+void Checkpointer::clear()
+{
+	keyframes.clear();
+	deltas.clear();
+	tags.clear();
+}
+
+void Checkpointer::__Rebuild(size_t index, SimSnapshot& state) const
+{
+	if (index >= tags.size()) {
+		throw std::out_of_range("Checkpoint index out of range");
+	}
+
+	size_t keyframe = index / keyframeInterval;
+	state = keyframes[keyframe];
+	for (size_t i = keyframe * keyframeInterval + 1; i <= index; i++) {
+		deltas[i].apply(state);
+	}
+}
+
+void Checkpointer::writeFile(const std::string& path) const
+{
+	std::ofstream file(path, std::ios::binary);
+	if (!file) {
+		throw std::runtime_error("Failed to open checkpoints for writing: " + path);
+	}
+
+	cereal::BinaryOutputArchive archive(file);
+	archive(*this);
+}
+
+Checkpointer Checkpointer::readFile(const std::string& path)
+{
+	std::ifstream file(path, std::ios::binary);
+	if (!file) {
+		throw std::runtime_error("Failed to open checkpoints: " + path);
+	}
+
+	Checkpointer result;
+	try {
+		cereal::BinaryInputArchive archive(file);
+		archive(result);
+	}
+	catch (const cereal::Exception& e) {
+		throw std::runtime_error("Checkpoints are truncated or corrupt: " + path + " (" + e.what() + ")");
+	}
+	return result;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Snapshot.h"
+
+class SnakeSim;
+
+// A history of checkpoints of a running sim. Every keyframeInterval'th checkpoint is a full snapshot and the ones in
+// between are deltas against the checkpoint before them, so a checkpoint costs about as much as the cells that changed
+// since the last one, and getting any checkpoint back only ever applies a handful of deltas. Each checkpoint carries a
+// tag picked by the caller, the game uses it for how many ticks into the session the checkpoint was taken
+class Checkpointer {
+public:
+	// maxCheckpoints of 0 keeps everything, otherwise the oldest keyframe and its deltas are dropped once it is reached
+	Checkpointer(uint32_t keyframeInterval = 30, size_t maxCheckpoints = 0);
+
+	void capture(const SnakeSim& sim, uint64_t tag = 0); // add a checkpoint of where the sim is now
+
+	void restore(SnakeSim& sim, size_t index) const; // put the sim back to a checkpoint, leaving the history alone (for branching)
+	void rewind(SnakeSim& sim, size_t index); // put the sim back to a checkpoint, and forget every checkpoint after it
+	void clear(); // forget every checkpoint
+
+	size_t size() const { return tags.size(); }
+	bool empty() const { return tags.empty(); }
+	uint64_t getTag(size_t index) const { return tags[index]; }
+
+	void writeFile(const std::string& path) const; // throws if the file can't be written
+	static Checkpointer readFile(const std::string& path); // throws if the file can't be read or isn't a checkpoint file
+
+	template<class Archive> void save(Archive& archive) const {
+		archive(MAGIC, VERSION, keyframeInterval, (uint64_t)maxCheckpoints, keyframes, deltas, tags, latest);
+	}
+	template<class Archive> void load(Archive& archive) {
+		uint32_t magic, version;
+		uint64_t max;
+		archive(magic, version);
+		if (magic != MAGIC || version != VERSION) {
+			throw std::runtime_error("Not a checkpoint file, or one from a different version of the game");
+		}
+		archive(keyframeInterval, max, keyframes, deltas, tags, latest);
+		maxCheckpoints = (size_t)max;
+		if (keyframeInterval == 0 || deltas.size() != tags.size() || keyframes.size() != (tags.size() + keyframeInterval - 1) / keyframeInterval) {
+			throw std::runtime_error("Checkpoint file is corrupt");
+		}
+	}
+
+private:
+	static constexpr uint32_t MAGIC = 0x504B4E53; // "SNKP"
+	static constexpr uint32_t VERSION = 2; // 2 stores only the moved slots of the empty cell index
+
+	void __Rebuild(size_t index, SimSnapshot& state) const; // the snapshot of a checkpoint, from its keyframe and deltas
+
+	uint32_t keyframeInterval;
+	size_t maxCheckpoints;
+
+	std::vector<SimSnapshot> keyframes; // checkpoint i * keyframeInterval
+	std::vector<SimDelta> deltas; // one per checkpoint, against the checkpoint before it. Unused (empty) for keyframes
+	std::vector<uint64_t> tags; // one per checkpoint
+
+	SimSnapshot latest; // the newest checkpoint, what the next delta is taken against
+	SimSnapshot scratch; // where the sim is saved to before diffing, kept around to reuse its storage
+};
+
+// Shorthand for shared_ptr
+typedef std::shared_ptr<Checkpointer> Checkpointer_sptr;
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <GLM/glm.hpp>
+#include <entt.hpp>
+
+// Components for the entities the game draws. They only hold data, everything that acts on them lives in SnakeWorld's
+// systems. The sim decides what happens each tick, so these only hold what the render batch needs to draw it (and the
+// links that let the snake move without rebuilding)
+
+// The cell of the board an entity is sitting in
+struct GridPos {
+	glm::ivec2 cell;
+};
+
+// Anything that gets drawn as a square
+struct Renderable {
+	glm::vec4 colour;
+	float size; // width of the square, in screen units
+};
+
+// A piece of the snake's body, and the piece in front of it (null for the head). Following next from the tail walks the
+// snake in the same order as SnakeSim::getSnek(), backwards
+struct BodySegment {
+	entt::entity next;
+};
+
+// An entity that moved into its cell on the last tick, it is drawn sliding over from the cell it came from
+struct Slide {
+	glm::ivec2 from;
+};
+
+// An entity that sits at a fixed spot on the screen rather than on the board (the score dots)
+struct ScreenPos {
+	glm::vec2 position;
+};
@@ -0,0 +1,101 @@
+#include "FileWatcher.h"
+#include "Logging.h"
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace {
+	// how often the modification times are checked where there is no inotify
+	const std::chrono::milliseconds CHECK_INTERVAL(250);
+
+	std::filesystem::file_time_type writeTime(const std::filesystem::path& path) {
+		std::error_code error;
+		std::filesystem::file_time_type time = std::filesystem::last_write_time(path, error);
+		return error ? std::filesystem::file_time_type::min() : time;
+	}
+}
+
+FileWatcher::FileWatcher() {
+#ifdef __linux__
+	myInotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (myInotify < 0) {
+		LOG_WARN("Failed to start inotify, files won't be watched");
+	}
+#endif
+	myNextCheck = std::chrono::steady_clock::now();
+}
+
+FileWatcher::~FileWatcher() {
+#ifdef __linux__
+	if (myInotify >= 0) {
+		close(myInotify);
+	}
+#endif
+}
+
+void FileWatcher::Add(const std::string& path) {
+	Watched file;
+	file.path = std::filesystem::absolute(path);
+	file.watch = -1;
+	file.writeTime = writeTime(file.path);
+
+#ifdef __linux__
+	// watching the same directory twice hands back the same descriptor
+	if (myInotify >= 0) {
+		std::string directory = file.path.parent_path().string();
+		file.watch = inotify_add_watch(myInotify, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+		if (file.watch < 0) {
+			LOG_WARN("Failed to watch {}", directory);
+		}
+	}
+#endif
+
+	myFiles.push_back(file);
+}
+
+bool FileWatcher::Poll() {
+	bool changed = false;
+
+#ifdef __linux__
+	if (myInotify < 0) {
+		return false;
+	}
+
+	// drain every event that has queued up, the fd is non-blocking so this stops as soon as there are none left
+	alignas(inotify_event) char buffer[4096];
+	ssize_t length;
+	while ((length = read(myInotify, buffer, sizeof(buffer))) > 0) {
+		for (ssize_t offset = 0; offset < length;) {
+			const inotify_event* event = (const inotify_event*)(buffer + offset);
+			offset += sizeof(inotify_event) + event->len;
+
+			if (event->len == 0) {
+				continue;
+			}
+			for (const Watched& file : myFiles) {
+				if (file.watch == event->wd && file.path.filename() == event->name) {
+					changed = true;
+				}
+			}
+		}
+	}
+#else
+	auto now = std::chrono::steady_clock::now();
+	if (now < myNextCheck) {
+		return false;
+	}
+	myNextCheck = now + CHECK_INTERVAL;
+
+	for (Watched& file : myFiles) {
+		std::filesystem::file_time_type time = writeTime(file.path);
+		if (time != file.writeTime) {
+			file.writeTime = time;
+			changed = true;
+		}
+	}
+#endif
+
+	return changed;
+}
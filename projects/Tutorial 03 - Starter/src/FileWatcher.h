@@ -0,0 +1,40 @@
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Tells when any of a handful of files have been saved, without ever blocking. On Linux this is an inotify watch on
+// each file's directory, since a lot of editors save by writing a new file and renaming it over the old one, which a
+// watch on the file itself would lose track of. Everywhere else the files' modification times are checked a few
+// times a second
+class FileWatcher {
+public:
+	typedef std::shared_ptr<FileWatcher> Sptr;
+
+	FileWatcher();
+	~FileWatcher();
+
+	FileWatcher(const FileWatcher&) = delete;
+	FileWatcher& operator=(const FileWatcher&) = delete;
+
+	void Add(const std::string& path); // start watching a file, it doesn't have to exist yet
+
+	bool Poll(); // true if a watched file has been written to since the last poll
+
+private:
+	struct Watched {
+		std::filesystem::path path;
+		int watch; // inotify watch descriptor of the file's directory, unused outside of Linux
+		std::filesystem::file_time_type writeTime; // last write time we saw, unused on Linux
+	};
+	std::vector<Watched> myFiles;
+
+	int myInotify = -1; // Linux only
+	std::chrono::steady_clock::time_point myNextCheck; // when to look at the modification times again, not on Linux
+};
+
+// Shorthand for shared_ptr
+typedef std::shared_ptr<FileWatcher> FileWatcher_sptr;
@@ -0,0 +1,54 @@
+#include "FixedTimestep.h"
+
+#include <cmath>
+#include <stdexcept>
+
+FixedTimestep::FixedTimestep(double tickRate, int maxStepsPerFrame) :
+	tickSeconds(1.0 / tickRate),
+	accumulator(0.0),
+	maxStepsPerFrame(maxStepsPerFrame)
+{ }
+
+int FixedTimestep::advance(double frameSeconds)
+{
+	// a negative frame time would only happen if the clock went backwards, just ignore it
+	if (frameSeconds > 0.0) {
+		accumulator += frameSeconds;
+	}
+
+	int steps = 0;
+	while (accumulator >= tickSeconds && steps < maxStepsPerFrame) {
+		accumulator -= tickSeconds;
+		steps++;
+	}
+
+	// if we are still behind after catching up as much as we are allowed, drop the extra ticks but keep our place
+	// within the current one
+	if (accumulator >= tickSeconds) {
+		accumulator = fmod(accumulator, tickSeconds);
+	}
+
+	return steps;
+}
+
+void FixedTimestep::setTickRate(double ticksPerSecond)
+{
+	// a tick rate of 0 would make every tick infinitely long, and a negative (or NaN) one would tick forever
+	if (!(ticksPerSecond > 0.0)) {
+		throw std::runtime_error("Tick rate has to be above 0");
+	}
+
+	// keep the same fraction of a tick in the accumulator, so the interpolation doesn't jump
+	double alpha = getAlpha();
+	tickSeconds = 1.0 / ticksPerSecond;
+	accumulator = alpha * tickSeconds;
+}
+
+void FixedTimestep::setMaxStepsPerFrame(int maxSteps)
+{
+	// with no steps allowed the sim would never move
+	if (maxSteps < 1) {
+		throw std::runtime_error("Frames have to be allowed at least 1 tick");
+	}
+	maxStepsPerFrame = maxSteps;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+// Turns variable length frames into a whole number of fixed length ticks. Frame time is added to an accumulator, and
+// every full tick's worth of time in it is handed out as a step. If a frame takes too long (a hitch, dragging the
+// window, a breakpoint) we only catch up a bounded number of steps and drop the rest, so the game slows down for a
+// moment instead of lurching forward
+class FixedTimestep {
+public:
+	FixedTimestep(double tickRate = 10.0, int maxStepsPerFrame = 5);
+
+	// adds frameSeconds to the accumulator and returns how many ticks should be run this frame
+	int advance(double frameSeconds);
+
+	// how far we are between the last tick and the next one, from 0 to 1. Used to interpolate rendering between sim states
+	double getAlpha() const { return accumulator / tickSeconds; }
+
+	void setTickRate(double ticksPerSecond); // number of ticks per second, throws if it isn't above 0
+	double getTickRate() const { return 1.0 / tickSeconds; }
+	double getTickSeconds() const { return tickSeconds; }
+
+	void setMaxStepsPerFrame(int maxSteps); // how many ticks a single frame may catch up, throws if it is less than 1
+	int getMaxStepsPerFrame() const { return maxStepsPerFrame; }
+
+	void reset() { accumulator = 0.0; } // forget any time that hasn't been ticked yet
+
+private:
+	double tickSeconds; // length of one tick
+	double accumulator; // time that has passed but hasn't been ticked yet, always less than one tick after advance
+	int maxStepsPerFrame; // the most ticks we will run in a single frame
+};
@@ -0,0 +1,183 @@
+#include "FrameCapture.h"
+#include "Logging.h"
+#include "Profiler.h"
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+
+#include "stb_image_write.h"
+
+FrameCapture::FrameCapture(int width, int height) :
+	myFences{ nullptr, nullptr },
+	myPendingFrame{ 0, 0 },
+	myWidth(width),
+	myHeight(height)
+{
+	if (width <= 0 || height <= 0) {
+		throw std::runtime_error("Offscreen framebuffer must be at least 1x1!");
+	}
+
+	glCreateRenderbuffers(1, &myColor);
+	glNamedRenderbufferStorage(myColor, GL_RGBA8, width, height);
+
+	glCreateFramebuffers(1, &myFramebuffer);
+	glNamedFramebufferRenderbuffer(myFramebuffer, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, myColor);
+	if (glCheckNamedFramebufferStatus(myFramebuffer, GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+		glDeleteFramebuffers(1, &myFramebuffer);
+		glDeleteRenderbuffers(1, &myColor);
+		throw std::runtime_error("Offscreen framebuffer is incomplete!");
+	}
+
+	// Only the GPU writes these and only we read them, so they get a storage we can map for reading
+	glCreateBuffers(2, myPixelBuffers);
+	for (GLuint buffer : myPixelBuffers) {
+		glNamedBufferStorage(buffer, (GLsizeiptr)width * height * 4, nullptr, GL_MAP_READ_BIT);
+	}
+	Profiler::CountGlObjects(4);
+
+	myEncoder = std::thread(&FrameCapture::__EncodeLoop, this);
+}
+
+FrameCapture::~FrameCapture() {
+	{
+		std::lock_guard<std::mutex> lock(myEncodeMutex);
+		myStopEncoding = true;
+	}
+	myEncodeChanged.notify_all();
+	myEncoder.join();
+
+	for (GLsync& fence : myFences) {
+		if (fence != nullptr) {
+			glDeleteSync(fence);
+		}
+	}
+	glDeleteBuffers(2, myPixelBuffers);
+	glDeleteFramebuffers(1, &myFramebuffer);
+	glDeleteRenderbuffers(1, &myColor);
+}
+
+void FrameCapture::SetOutput(const std::string& directory, int every) {
+	{
+		std::lock_guard<std::mutex> lock(myEncodeMutex); // the encoder reads it
+		myDirectory = directory;
+	}
+	myEvery = every > 0 ? every : 1;
+
+	if (!myDirectory.empty()) {
+		std::filesystem::create_directories(myDirectory);
+	}
+}
+
+void FrameCapture::Bind() {
+	glBindFramebuffer(GL_FRAMEBUFFER, myFramebuffer);
+	glViewport(0, 0, myWidth, myHeight);
+}
+
+void FrameCapture::EndFrame() {
+	uint64_t frame = myFrame++;
+	if (myDirectory.empty() || frame % myEvery != 0) {
+		return;
+	}
+
+	// Queue the copy into a pixel buffer, this returns straight away
+	int buffer = myNextBuffer;
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, myFramebuffer);
+	glNamedFramebufferReadBuffer(myFramebuffer, GL_COLOR_ATTACHMENT0);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, myPixelBuffers[buffer]);
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glReadPixels(0, 0, myWidth, myHeight, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	myFences[buffer] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	myPendingFrame[buffer] = frame;
+
+	// The other buffer was queued on the last frame we kept, so its copy should be done by now
+	myNextBuffer = 1 - buffer;
+	if (myFences[myNextBuffer] != nullptr) {
+		__Write(myNextBuffer);
+	}
+}
+
+void FrameCapture::Finish() {
+	// The older of the two has to go out first, so the frames are written in order
+	int older = myNextBuffer;
+	for (int buffer : { older, 1 - older }) {
+		if (myFences[buffer] != nullptr) {
+			__Write(buffer);
+		}
+	}
+
+	std::unique_lock<std::mutex> lock(myEncodeMutex);
+	myEncodeChanged.wait(lock, [this]() { return myEncodeQueue.empty() && !myEncoding; });
+}
+
+void FrameCapture::__Write(int buffer) {
+	// Usually already signalled, this only waits if the GPU is more than a frame behind
+	glClientWaitSync(myFences[buffer], GL_SYNC_FLUSH_COMMANDS_BIT, UINT64_MAX);
+	glDeleteSync(myFences[buffer]);
+	myFences[buffer] = nullptr;
+
+	const void* pixels = glMapNamedBufferRange(myPixelBuffers[buffer], 0, (GLsizeiptr)myWidth * myHeight * 4, GL_MAP_READ_BIT);
+	if (pixels == nullptr) {
+		LOG_WARN("Failed to map frame {} for capture", myPendingFrame[buffer]);
+		return;
+	}
+
+	// only waits if the encoder has fallen a few frames behind, which keeps how much memory the copies take bounded
+	std::unique_lock<std::mutex> lock(myEncodeMutex);
+	myEncodeChanged.wait(lock, [this]() { return myEncodeQueue.size() < MAX_QUEUED_FRAMES; });
+
+	Encode encode;
+	encode.Frame = myPendingFrame[buffer];
+	if (!myFreePixels.empty()) {
+		encode.Pixels = std::move(myFreePixels.back());
+		myFreePixels.pop_back();
+	}
+	lock.unlock();
+
+	// GL's rows start at the bottom of the image, PNG's at the top, so the rows are flipped as they're copied out
+	size_t rowSize = (size_t)myWidth * 4;
+	encode.Pixels.resize(rowSize * myHeight);
+	for (int y = 0; y < myHeight; y++) {
+		memcpy(&encode.Pixels[rowSize * y], (const uint8_t*)pixels + rowSize * (myHeight - 1 - y), rowSize);
+	}
+	glUnmapNamedBuffer(myPixelBuffers[buffer]);
+
+	lock.lock();
+	myEncodeQueue.push_back(std::move(encode));
+	lock.unlock();
+	myEncodeChanged.notify_all();
+}
+
+void FrameCapture::__EncodeLoop() {
+	std::unique_lock<std::mutex> lock(myEncodeMutex);
+	while (true) {
+		myEncodeChanged.wait(lock, [this]() { return !myEncodeQueue.empty() || myStopEncoding; });
+		if (myEncodeQueue.empty()) {
+			return;
+		}
+
+		Encode encode = std::move(myEncodeQueue.front());
+		myEncodeQueue.pop_front();
+		myEncoding = true;
+		std::string directory = myDirectory;
+		lock.unlock();
+
+		char name[32];
+		snprintf(name, sizeof(name), "frame_%06llu.png", (unsigned long long)encode.Frame);
+		std::string path = (std::filesystem::path(directory) / name).string();
+
+		if (stbi_write_png(path.c_str(), myWidth, myHeight, 4, encode.Pixels.data(), myWidth * 4) == 0) {
+			LOG_WARN("Failed to write {}", path);
+		}
+		else {
+			mySaved++;
+		}
+
+		lock.lock();
+		myFreePixels.push_back(std::move(encode.Pixels));
+		myEncoding = false;
+		myEncodeChanged.notify_all();
+	}
+}
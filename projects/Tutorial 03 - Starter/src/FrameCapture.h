@@ -0,0 +1,78 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// An offscreen framebuffer for rendering the game without a visible window, which can save frames out as PNGs.
+// Frames are read back into one of two pixel buffers, and a frame is only mapped and written out once the next frame
+// we keep has been started, so the GPU has had a whole frame to finish the copy and the read never stalls the pipeline.
+// Encoding a PNG takes far longer than rendering a frame, so that happens on a worker thread from a copy of the pixels
+class FrameCapture {
+public:
+	typedef std::shared_ptr<FrameCapture> Sptr;
+
+	// Creates a width x height color target and the pixel buffers to read it back into, needs a current GL context
+	FrameCapture(int width, int height);
+	~FrameCapture();
+
+	// Where frames are written (as frame_000000.png, numbered by frame), and how often. Empty to not write anything
+	void SetOutput(const std::string& directory, int every = 1);
+
+	// Makes the offscreen framebuffer the render target for this frame, and sets the viewport to cover it
+	void Bind();
+	// Starts reading this frame back if it is one we keep, and writes out the frame that was read back before it
+	void EndFrame();
+	// Writes out the frame that is still being read back, and waits for every frame to be encoded. Call before shutting down
+	void Finish();
+
+	int GetWidth() const { return myWidth; }
+	int GetHeight() const { return myHeight; }
+	uint64_t GetFrameCount() const { return myFrame; } // frames rendered so far
+	uint64_t GetSavedCount() const { return mySaved; } // frames written out so far
+
+private:
+	// A frame copied out of a pixel buffer, waiting to be encoded
+	struct Encode {
+		uint64_t Frame;
+		std::vector<uint8_t> Pixels; // top row first
+	};
+	// How many frames can be waiting on the encoder before EndFrame waits for it to catch up
+	static constexpr size_t MAX_QUEUED_FRAMES = 4;
+
+	// Waits for the given pixel buffer's copy to land, then maps it and hands a copy to the encoder
+	void __Write(int buffer);
+	// Body of the encoder thread, writes out queued frames until it is stopped
+	void __EncodeLoop();
+
+	GLuint myFramebuffer;
+	GLuint myColor; // RGBA8 renderbuffer the game draws into
+	GLuint myPixelBuffers[2];
+	GLsync myFences[2]; // signalled once the copy into the matching pixel buffer is done, null if nothing is in flight
+	uint64_t myPendingFrame[2]; // which frame is in each pixel buffer
+	int myNextBuffer = 0; // the pixel buffer the next frame we keep is read into
+
+	int myWidth, myHeight;
+	std::string myDirectory;
+	int myEvery = 1;
+	uint64_t myFrame = 0;
+	std::atomic<uint64_t> mySaved{ 0 };
+
+	std::thread myEncoder;
+	std::mutex myEncodeMutex; // guards everything below
+	std::condition_variable myEncodeChanged; // signalled when a frame is queued or finished, or the encoder is stopped
+	std::deque<Encode> myEncodeQueue;
+	std::vector<std::vector<uint8_t>> myFreePixels; // copies the encoder is done with, reused so frames don't allocate
+	bool myEncoding = false; // the encoder has taken a frame off the queue and is still writing it
+	bool myStopEncoding = false;
+};
+
+// Shorthand for shared_ptr
+typedef std::shared_ptr<FrameCapture> FrameCapture_sptr;
@@ -0,0 +1,87 @@
+#include "FreeCellSet.h"
+
+#include <stdexcept>
+
+FreeCellSet::FreeCellSet() :
+	count(0)
+{ }
+
+void FreeCellSet::reset(uint32_t cellCount)
+{
+	// starting over on the same board only has to rewind the pages that were swapped
+	if (cellCount == cells.size()) {
+		cells.reset();
+		slots.reset();
+	}
+	else {
+		cells.resize(cellCount);
+		slots.resize(cellCount);
+	}
+
+	count = cellCount;
+}
+
+void FreeCellSet::insert(uint32_t cell)
+{
+	if (contains(cell)) {
+		return;
+	}
+
+	// move the cell into the first taken slot, and grow the free section over it
+	swapSlots(slots.get(cell), count);
+	count++;
+}
+
+void FreeCellSet::remove(uint32_t cell)
+{
+	if (!contains(cell)) {
+		return;
+	}
+
+	// move the cell into the last free slot, and shrink the free section past it
+	count--;
+	swapSlots(slots.get(cell), count);
+}
+
+void FreeCellSet::swapSlots(uint32_t a, uint32_t b)
+{
+	uint32_t cellA = cells.get(a);
+	uint32_t cellB = cells.get(b);
+
+	cells.set(a, cellB);
+	cells.set(b, cellA);
+	slots.set(cellA, b);
+	slots.set(cellB, a);
+}
+
+void FreeCellSet::save(std::vector<uint32_t>& savedSlots, std::vector<uint32_t>& savedCells) const
+{
+	savedSlots.clear();
+	savedCells.clear();
+	cells.forEachWritten([&](uint32_t slot, uint32_t cell) {
+		if (cell != slot) {
+			savedSlots.push_back(slot);
+			savedCells.push_back(cell);
+		}
+	});
+}
+
+void FreeCellSet::restore(uint32_t cellCount, const std::vector<uint32_t>& savedSlots, const std::vector<uint32_t>& savedCells, uint32_t freeCount)
+{
+	if (savedSlots.size() != savedCells.size() || freeCount > cellCount) {
+		throw std::runtime_error("Saved free cell order is corrupt");
+	}
+
+	reset(cellCount);
+
+	// every slot that isn't listed still holds its own cell, so the listed ones are a permutation among themselves
+	for (size_t i = 0; i < savedSlots.size(); i++) {
+		if (savedSlots[i] >= cellCount || savedCells[i] >= cellCount) {
+			throw std::runtime_error("Saved free cell order is corrupt");
+		}
+		cells.set(savedSlots[i], savedCells[i]);
+		slots.set(savedCells[i], savedSlots[i]);
+	}
+
+	count = freeCount;
+}
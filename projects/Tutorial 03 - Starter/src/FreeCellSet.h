@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "PagedArray.h"
+
+// Keeps track of which cells of the board are free, so a uniformly random free cell can be picked in constant time
+// no matter how full the board is. Every cell index lives in one array, with the free cells packed at the front, and a
+// second array remembers where each cell is. Freeing or filling a cell just swaps it across the boundary.
+// Both arrays start out as the identity, and only the pages holding a slot that has been swapped are ever stored, so
+// a fresh set costs nothing no matter how many cells there are
+class FreeCellSet {
+public:
+	FreeCellSet();
+
+	void reset(uint32_t cellCount); // marks all cellCount cells as free
+	void reserve(uint32_t cellCount) { cells.reserve(cellCount); slots.reserve(cellCount); } // room to swap that many cells without allocating
+
+	void insert(uint32_t cell); // marks a cell as free, does nothing if it already is
+	void remove(uint32_t cell); // marks a cell as taken, does nothing if it already is
+	bool contains(uint32_t cell) const { return slots.get(cell) < count; } // whether the cell is free
+
+	uint32_t size() const { return count; } // number of free cells
+	uint32_t capacity() const { return cells.size(); } // number of cells, free or not
+	uint32_t operator[](uint32_t i) const { return cells.get(i); } // the i'th free cell, i must be less than size()
+
+	// The order of the cells decides which one a random pick lands on, so it is part of what has to be saved to put a
+	// sim back exactly how it was. Only the slots that don't hold their own index are saved, with the cell in each, by
+	// ascending slot. That is about two slots for every cell that has been filled
+	void save(std::vector<uint32_t>& savedSlots, std::vector<uint32_t>& savedCells) const;
+	// put back an order from save(), with the first freeCount slots free
+	void restore(uint32_t cellCount, const std::vector<uint32_t>& savedSlots, const std::vector<uint32_t>& savedCells, uint32_t freeCount);
+
+private:
+	void swapSlots(uint32_t a, uint32_t b); // swap the cells sitting in two slots, keeping the lookup up to date
+
+	PagedArray<uint32_t, FillIndex> cells; // every cell index, free ones first
+	PagedArray<uint32_t, FillIndex> slots; // where each cell index is in cells
+	uint32_t count; // number of free cells at the front of cells
+};
@@ -1,7 +1,13 @@
 #include "Game.h"
 #include "Logging.h"
+#include "AllocCounter.h"
+#include "Profiler.h"
+#include "Trace.h"
 
 #include <stdexcept>
+#include <random>
+#include <chrono>
+#include <thread>
 
 #define IMGUI_IMPL_OPENGL_LOADER_GLAD
 #include "imgui.h"
@@ -45,24 +51,35 @@ void Game::KeyPressed(GLFWwindow* window, int key) {
 	// checks key value.
 	switch (key)
 	{
-	case GLFW_KEY_ESCAPE:
-		exit(0);
+	case GLFW_KEY_ESCAPE: // close through the main loop, so that shutdown gets to save the replay
+		glfwSetWindowShouldClose(window, true);
 		break;
-	case GLFW_KEY_W:
-		if(snek[0]->getDirection() != 1)
-			game->snek[0]->setDirection(0);
+	case GLFW_KEY_W: // the sim ignores turns back onto the snake, so we just pass the direction along
+		game->myInput = 0;
 		break;
 	case GLFW_KEY_S:
-		if (snek[0]->getDirection() != 0)
-			game->snek[0]->setDirection(1);
+		game->myInput = 1;
 		break;
 	case GLFW_KEY_A:
-		if (snek[0]->getDirection() != 3)
-			game->snek[0]->setDirection(2);
+		game->myInput = 2;
 		break;
 	case GLFW_KEY_D:
-		if (snek[0]->getDirection() != 2)
-			game->snek[0]->setDirection(3);
+		game->myInput = 3;
+		break;
+	case GLFW_KEY_BACKSPACE: // step back about a second
+		game->Rewind();
+		break;
+	case GLFW_KEY_F5: // save now instead of waiting for the autosave
+		game->SaveCheckpoints();
+		break;
+	case GLFW_KEY_F9: // pick up from the last save
+		game->LoadCheckpoints();
+		break;
+	case GLFW_KEY_F3: // show or hide the profiler
+		game->myShowProfiler = !game->myShowProfiler;
+		break;
+	case GLFW_KEY_F8: // write out the last few seconds of spans, for looking at a stutter that just happened
+		game->DumpTrace();
 		break;
 	}
 }
@@ -72,6 +89,11 @@ void Game::KeyHeld(GLFWwindow* window, int key) {
 
 	if (game == nullptr) // if game is 'null', then it is returned
 		return;
+
+	// holding backspace keeps rewinding
+	if (key == GLFW_KEY_BACKSPACE) {
+		game->Rewind();
+	}
 }
 
 void Game::KeyReleased(GLFWwindow* window, int key) {
@@ -113,51 +135,126 @@ void KeyCallback(GLFWwindow* window, int key, int scancode, int action, int mods
 Game::Game() :
 	myWindow(nullptr),
 	myWindowTitle("Game"),
-	myClearColor(glm::vec4(0, 0, 0, 1))
-{ }
+	myClearColor(glm::vec4(0, 0, 0, 1)),
+	myTimestep(1.0 / SnakeSim::TICK_SECONDS)
+{
+	// Pick a fresh seed every launch, unless one is given with SetSeed
+	std::random_device device;
+	mySeed = ((uint64_t)device() << 32) | device();
 
-Game::~Game() { }
+	myAutosaver = std::thread(&Game::__AutosaveLoop, this);
+}
+
+Game::~Game() {
+	// the autosaver writes whatever it was handed last before stopping
+	{
+		std::lock_guard<std::mutex> lock(myAutosaveMutex);
+		myStopAutosaving = true;
+	}
+	myAutosaveChanged.notify_all();
+	myAutosaver.join();
+}
 
 void Game::Run()
 {
 	Initialize();
-	//InitImGui();
+	InitImGui();
+	Profiler::InitGpu();
 
 	LoadContent();
 
-	static float prevFrame = glfwGetTime();
+	TRACE_THREAD_NAME("Main");
+
+	double prevFrame = glfwGetTime();
 	
 	// Run as long as the window is open
 	while (!glfwWindowShouldClose(myWindow)) {
 
-		float thisFrame = glfwGetTime();
-		float deltaTime = thisFrame - prevFrame;
+		double thisFrame = glfwGetTime();
+		float deltaTime = (float)(thisFrame - prevFrame);
+		prevFrame = thisFrame;
 
-		Update(deltaTime);
-		Draw(deltaTime);
+		// offscreen frames are spaced evenly no matter how long they take, so every run renders the same frames
+		if (myOffscreen) {
+			deltaTime = 1.0f / 60.0f;
+		}
 
-		//ImGuiNewFrame();
-		//DrawGui(deltaTime);
-		//ImGuiEndFrame();
+		Profiler::BeginFrame();
+		TRACE_BEGIN("Frame");
 
-		// Present our image to windows
-		glfwSwapBuffers(myWindow);
+		{
+			TRACE_SCOPE("Update");
+			Profiler::Scope timer(Profiler::Metric::Update);
+			Update(deltaTime);
+		}
+		{
+			TRACE_SCOPE("Draw");
+			Profiler::Scope timer(Profiler::Metric::Draw);
+			Profiler::BeginGpuTimer();
+			Draw(deltaTime);
+			Profiler::EndGpuTimer();
+		}
+		// the debug windows show wall clock timings, which would make every captured frame different
+		if (!myOffscreen) {
+			TRACE_SCOPE("Gui");
+			Profiler::Scope timer(Profiler::Metric::Gui);
+			ImGuiNewFrame();
+			DrawGui(deltaTime);
+			ImGuiEndFrame();
+		}
+
+		if (myOffscreen) {
+			TRACE_SCOPE("Capture");
+			myCapture->EndFrame();
+
+			bool finished = myOffscreenFrames > 0 ?
+				myCapture->GetFrameCount() >= myOffscreenFrames :
+				myPlayback != nullptr && myPlaybackCursor->done();
+			if (finished) {
+				glfwSetWindowShouldClose(myWindow, true);
+			}
+		}
+		else {
+			// Present our image to windows
+			TRACE_BEGIN("SwapBuffers");
+			glfwSwapBuffers(myWindow);
+			TRACE_END();
+		}
 
 		// Poll for events from windows (clicks, keypressed, closing, all that)
+		TRACE_BEGIN("PollEvents");
 		glfwPollEvents();
+		TRACE_END();
+
+		TRACE_END();
+		Profiler::EndFrame();
+
+		// Don't burn a whole core if we have a frame cap
+		LimitFrameRate(thisFrame);
 	}
 
 	LOG_INFO("Shutting down...");
 
+	SaveReplay();
+	SaveCheckpoints();
+	DumpTrace();
+
+	// the last frame or two are still being read back, and the framebuffer has to go before the context does
+	if (myCapture != nullptr) {
+		myCapture->Finish();
+		LOG_INFO("Rendered {} offscreen frames, saved {}", myCapture->GetFrameCount(), myCapture->GetSavedCount());
+		myCapture = nullptr;
+	}
+
 	UnloadContent();
 
+	Profiler::ShutdownGpu();
 	ShutdownImGui();
 	Shutdown();
 }
 
 void Game::Initialize() {
 
-	srand(time(NULL));
 	// Initialize GLFW
 	if (glfwInit() == GLFW_FALSE) {
 		std::cout << "Failed to initialize GLFW" << std::endl;
@@ -167,8 +264,24 @@ void Game::Initialize() {
 	// Enable transparent backbuffers for our windows (note that Windows expects our colors to be pre-multiplied with alpha)
 	glfwWindowHint(GLFW_TRANSPARENT_FRAMEBUFFER, true);
 
+	// Offscreen we only need the window for its context, so it is never shown
+	if (myOffscreen) {
+		glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+		switch (myContextApi) {
+		case ContextApi::Egl:    glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_EGL_CONTEXT_API); break;
+		case ContextApi::OsMesa: glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API); break;
+		default: break;
+		}
+	}
+
 	// Create a new GLFW window
-	myWindow = glfwCreateWindow(800, 800, myWindowTitle, nullptr, nullptr);
+	int width = myOffscreen ? myOffscreenWidth : 800;
+	int height = myOffscreen ? myOffscreenHeight : 800;
+	myWindow = glfwCreateWindow(width, height, myWindowTitle, nullptr, nullptr);
+	if (myWindow == nullptr) {
+		glfwTerminate();
+		throw std::runtime_error("Failed to create a window (or an OpenGL context)");
+	}
 
 	// Tie our game to our window, so we can access it via callbacks
 	glfwSetWindowUserPointer(myWindow, this);
@@ -194,6 +307,252 @@ void Game::Initialize() {
 	glDebugMessageCallback(GlDebugMessage, this); 
 	glfwSetKeyCallback(myWindow, KeyCallback);
 
+	// Now that we have a context, set up vsync
+	ApplyFrameMode();
+
+	// Everything gets drawn into here instead of the window
+	if (myOffscreen) {
+		myCapture = std::make_shared<FrameCapture>(myOffscreenWidth, myOffscreenHeight);
+		myCapture->SetOutput(myCaptureDirectory, myCaptureEvery);
+		LOG_INFO("Rendering offscreen at {}x{}", myOffscreenWidth, myOffscreenHeight);
+	}
+}
+
+void Game::SetSeed(uint64_t seed) {
+	// A replay only plays back against the seed it was recorded with
+	if (myPlayback != nullptr && seed != myPlayback->getSeed()) {
+		LOG_WARN("Ignoring seed {}, the replay being watched uses {}", seed, myPlayback->getSeed());
+		return;
+	}
+	mySeed = seed;
+
+	// If we are already running, start a new game from the seed straight away
+	if (mySim != nullptr) {
+		Restart();
+	}
+}
+
+void Game::SetBoardSize(int width, int height) {
+	SnakeSim::checkSize(width, height);
+	if (myPlayback != nullptr && (width != myPlayback->getWidth() || height != myPlayback->getHeight())) {
+		LOG_WARN("Ignoring board size {}x{}, the replay being watched is {}x{}", width, height, myPlayback->getWidth(), myPlayback->getHeight());
+		return;
+	}
+	myBoardWidth = width;
+	myBoardHeight = height;
+
+	if (mySim != nullptr) {
+		Restart();
+	}
+}
+
+void Game::Restart() {
+	mySim->reset(mySeed, myBoardWidth, myBoardHeight);
+	myReplay.begin(mySeed, myBoardWidth, myBoardHeight);
+	myCheckpoints.clear();
+	myCheckpoints.capture(*mySim, 0);
+	myWorld.rebuild(*mySim);
+}
+
+void Game::PlayReplay(const std::string& path) {
+	myPlayback = std::make_shared<Replay>(Replay::readFile(path));
+	myPlaybackCursor = std::make_unique<Replay::Cursor>(*myPlayback);
+	LOG_INFO("Playing {} ({} ticks, {} inputs)", path, myPlayback->getTickCount(), myPlayback->getInputCount());
+
+	// Watching isn't a session of its own, so don't record over the last one
+	myReplayPath.clear();
+	SetBoardSize(myPlayback->getWidth(), myPlayback->getHeight());
+	SetSeed(myPlayback->getSeed());
+}
+
+void Game::SetOffscreen(int width, int height, uint64_t frameCount, ContextApi api) {
+	myOffscreen = true;
+	myOffscreenWidth = width;
+	myOffscreenHeight = height;
+	myOffscreenFrames = frameCount;
+	myContextApi = api;
+
+	// there is no monitor to wait on, and no reason to wait
+	myFrameMode = FrameMode::Uncapped;
+}
+
+void Game::SetCapture(const std::string& directory, int every) {
+	myCaptureDirectory = directory;
+	myCaptureEvery = every;
+
+	if (myCapture != nullptr) {
+		myCapture->SetOutput(directory, every);
+	}
+}
+
+void Game::SaveReplay() {
+	if (myReplayPath.empty() || mySim == nullptr) {
+		return;
+	}
+
+	myReplay.finish(*mySim);
+	try {
+		myReplay.writeFile(myReplayPath);
+		LOG_INFO("Saved replay to {} ({} ticks, {} inputs)", myReplayPath, myReplay.getTickCount(), myReplay.getInputCount());
+	}
+	catch (const std::exception& e) {
+		// losing the replay isn't worth crashing over on the way out
+		LOG_WARN(e.what());
+	}
+}
+
+void Game::Rewind() {
+	// rewinding a replay that is being watched would desync it
+	if (myPlayback != nullptr || myCheckpoints.empty()) {
+		return;
+	}
+
+	// if we only just took a checkpoint, going back to it would barely move, so go back one more
+	size_t target = myCheckpoints.size() - 1;
+	if (target > 0 && myCheckpoints.getTag(target) + CHECKPOINT_TICKS / 2 >= myReplay.getTickCount()) {
+		target--;
+	}
+	myCheckpoints.rewind(*mySim, target);
+
+	// the session is deterministic, so the replay just has to forget what happened after the checkpoint
+	myReplay.truncate(myCheckpoints.getTag(target));
+
+	myWorld.rebuild(*mySim);
+}
+
+void Game::DumpTrace() {
+#ifdef ENABLE_TRACING
+	if (TRACE_DUMP("trace.json")) {
+		LOG_INFO("Wrote trace.json, open it in chrome://tracing or ui.perfetto.dev");
+	}
+	else {
+		LOG_WARN("Failed to write trace.json");
+	}
+#endif
+}
+
+void Game::SaveCheckpoints() {
+	if (myPlayback != nullptr || myAutosavePath.empty() || myCheckpoints.empty()) {
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(myAutosaveMutex);
+		// copy assigning reuses the storage of the copy before it, so this is little more than a memcpy of the history.
+		// If the last copy is still waiting it is replaced, only the newest history is worth writing
+		myAutosaveCopy = myCheckpoints;
+		myAutosaveCopyPath = myAutosavePath;
+		myAutosavePending = true;
+	}
+	myAutosaveChanged.notify_all();
+}
+
+void Game::__AutosaveLoop() {
+	TRACE_THREAD_NAME("Autosave");
+
+	// the copy being written, swapped with myAutosaveCopy so the two trade storage instead of reallocating
+	Checkpointer writing;
+	std::string path;
+
+	std::unique_lock<std::mutex> lock(myAutosaveMutex);
+	while (true) {
+		myAutosaveChanged.wait(lock, [this]() { return myAutosavePending || myStopAutosaving; });
+		if (!myAutosavePending) {
+			return;
+		}
+
+		std::swap(writing, myAutosaveCopy);
+		path = myAutosaveCopyPath;
+		myAutosavePending = false;
+		myAutosaving = true;
+		lock.unlock();
+
+		try {
+			TRACE_SCOPE("Write autosave");
+			writing.writeFile(path);
+		}
+		catch (const std::exception& e) {
+			LOG_WARN(e.what());
+		}
+
+		lock.lock();
+		myAutosaving = false;
+		myAutosaveChanged.notify_all();
+	}
+}
+
+void Game::LoadCheckpoints() {
+	if (myPlayback != nullptr) {
+		return;
+	}
+
+	// an autosave that is still being written would be read half finished
+	{
+		std::unique_lock<std::mutex> lock(myAutosaveMutex);
+		myAutosaveChanged.wait(lock, [this]() { return !myAutosavePending && !myAutosaving; });
+	}
+
+	try {
+		Checkpointer loaded = Checkpointer::readFile(myAutosavePath);
+		if (loaded.empty()) {
+			return;
+		}
+		loaded.rewind(*mySim, loaded.size() - 1);
+		myCheckpoints = std::move(loaded);
+	}
+	catch (const std::exception& e) {
+		LOG_WARN(e.what());
+		return;
+	}
+	LOG_INFO("Loaded {}", myAutosavePath);
+
+	// a replay can only start from a seed, so it can't describe a game that was picked up from a save
+	if (!myReplayPath.empty()) {
+		LOG_INFO("Stopped recording to {}, the game no longer starts from its seed", myReplayPath);
+		myReplayPath.clear();
+	}
+
+	// the loaded checkpoints are tagged with the ticks of the session that saved them, so this session's count carries
+	// on from the newest of them. New checkpoints are tagged after the loaded ones, and rewinding to one of the loaded
+	// ones truncates back to where it was taken
+	myReplay.resume(myCheckpoints.getTag(myCheckpoints.size() - 1));
+
+	myWorld.rebuild(*mySim);
+}
+
+void Game::SetTickRate(double ticksPerSecond) {
+	myTimestep.setTickRate(ticksPerSecond);
+}
+
+void Game::SetMaxCatchUpSteps(int maxSteps) {
+	myTimestep.setMaxStepsPerFrame(maxSteps);
+}
+
+void Game::SetFrameMode(FrameMode mode, double frameCap) {
+	myFrameMode = mode;
+	myFrameCap = frameCap;
+
+	// If we are already running, apply it straight away
+	if (myWindow != nullptr) {
+		ApplyFrameMode();
+	}
+}
+
+void Game::ApplyFrameMode() {
+	// Only vsync waits on the monitor, the other modes present immediately
+	glfwSwapInterval(myFrameMode == FrameMode::VSync ? 1 : 0);
+}
+
+void Game::LimitFrameRate(double frameStart) {
+	if (myFrameMode != FrameMode::Capped || myFrameCap <= 0.0) {
+		return;
+	}
+
+	// Sleep for whatever is left of this frame's time slice
+	double remaining = frameStart + 1.0 / myFrameCap - glfwGetTime();
+	if (remaining > 0.0) {
+		std::this_thread::sleep_for(std::chrono::duration<double>(remaining));
+	}
 }
 
 void Game::Shutdown() {
@@ -201,25 +560,24 @@ void Game::Shutdown() {
 }
 
 void Game::LoadContent() {
-	snek.push_back(new Object(glm::vec3(0, 0, 0), glm::vec4(0, 0, 1, 1), 0)); // head
-	snekMeshes.push_back(snek[0]->getMesh());
-	addSnekPart();
-
-	fruit = new Object(glm::vec3(0, 0, 0), glm::vec4(1, 0, 0, 1), -1);
-	newFruitPos(fruit);
-	fruitMesh = fruit->getMesh();
+	// Create the simulation that runs all of the game's rules. Every spawn comes from this seed, so log it to be able
+	// to reproduce the run later
+	LOG_INFO("Seed: {}, board {}x{}", mySeed, myBoardWidth, myBoardHeight);
+	mySim = std::make_shared<SnakeSim>(mySeed, myBoardWidth, myBoardHeight);
+	myReplay.begin(mySeed, myBoardWidth, myBoardHeight);
+	myCheckpoints.capture(*mySim, 0);
 
-	bigFruit = new Object(glm::vec3(0, 0, 0), glm::vec4(1, 1, 0, 1), -1);
-	newFruitPos(bigFruit);
-	bigFruitMesh = bigFruit->getMesh();
+	// Create an entity for everything on the board
+	myWorld.rebuild(*mySim);
 
-	dead.push_back(new Object(glm::vec3(0, 0, 0), glm::vec4(0, 1, 0, 1), -1));
-	newFruitPos(dead[0]);
-	deadMesh.push_back(dead[0]->getMesh());
+	// Create the renderer that all of our objects are batched into
+	myQuadRenderer = std::make_shared<QuadRenderer>();
 
 	// Create and compile shader
 	myShader = std::make_shared<Shader>();
-	myShader->Load("passthrough.vs", "passthrough.fs");
+	myShader->Load("passthrough_instanced.vs", "passthrough.fs");
+	// Saving either file rebuilds the shader while we keep running. Offscreen runs render fixed frames, so leave them be
+	myShader->SetHotReload(!myOffscreen);
 }
 
 void Game::UnloadContent() {
@@ -294,154 +652,83 @@ void Game::ImGuiEndFrame() {
 }
 
 void Game::Update(float deltaTime) {
-
-	CollisionCheck(); // check for collisions
-	timer = glfwGetTime() - 0.1 * count;
-
-	if (timer >= 0.1) {
-		
-		for (int i = snek.size() - 1; i >= 0; i--) {
-			if (i != 0) {
-				snek[i]->setDirection(snek[i - 1]->getDirection());
-			}
-
-			switch (snek[i]->getDirection()) {
-			case 0:
-				snek[i]->addToPosition(0, 0.05, 0);
-				break;
-			case 1:
-				snek[i]->addToPosition(0, -0.05, 0);
-				break;
-			case 2:
-				snek[i]->addToPosition(-0.05, 0, 0);
-				break;
-			case 3:
-				snek[i]->addToPosition(0.05, 0, 0);
+	// run however many fixed ticks fit into this frame, catching up a little if we fell behind
+	int steps = myTimestep.advance(deltaTime);
+
+	for (int i = 0; i < steps; i++) {
+		// when watching a replay the recorded input replaces the keyboard
+		int input = myInput;
+		if (myPlayback != nullptr) {
+			if (myPlaybackCursor->done()) {
 				break;
 			}
-			snekMeshes[i] = snek[i]->getMesh();
+			input = myPlaybackCursor->next();
 		}
+		myReplay.record(input);
+		myInput = -1;
 
-		count++;
-	}
-
-	obTimer = glfwGetTime() - 10 * obCount;
+		// a tick shouldn't need the heap at all, this warns us if that ever changes
+		AllocCounter::Scope tickAllocs;
 
-	if (obTimer >= 10.0f) {
-		dead.push_back(new Object(glm::vec3(0, 0, 0), glm::vec4(0, 1, 0, 1), -1));
-		newFruitPos(dead[dead.size() - 1]);
-		deadMesh.push_back(dead[dead.size() - 1]->getMesh());
-		obCount++;
-	}
-}
-
-void Game::CollisionCheck() {
-	for (int i = 1; i <= snek.size() - 1; i++) { // loop around screen
-		if (snek[i]->getPosition().x < -1.05) {
-			snek[i]->setPosition(glm::vec3(1.05, snek[i]->getPosition().y, snek[i]->getPosition().z));
-		}
-		else if (snek[i]->getPosition().x > 1.05) {
-			snek[i]->setPosition(glm::vec3(-1.05, snek[i]->getPosition().y, snek[i]->getPosition().z));
-		}
-		else if (snek[i]->getPosition().y < -1.05) {
-			snek[i]->setPosition(glm::vec3(snek[i]->getPosition().x, 1.05, snek[i]->getPosition().z));
-		}
-		else if (snek[i]->getPosition().y > 1.05) {
-			snek[i]->setPosition(glm::vec3(snek[i]->getPosition().x, -1.05, snek[i]->getPosition().z));
+		StepResult result;
+		{
+			TRACE_SCOPE("Sim step");
+			Profiler::Scope timer(Profiler::Metric::SimStep);
+			result = mySim->step(input); // advance the game by one tick with the latest key press
 		}
-	}
 
-	for (int i = 2; i < snek.size() - 1; i++) { // check for collision with self
-		if (collisionManager.isColliding(snek[1], snek[i])) {
-			resetGame(); // die if collidiing with self
+		if (tickAllocs.GetCount() > 0) {
+			LOG_WARN("Sim tick made {} heap allocations", tickAllocs.GetCount());
 		}
-	}
-
-	if (collisionManager.isColliding(snek[1], fruit) && whichFruit == 1) { // check for collision with fruit and add score
-		addSnekPart(); // add length to snek
-		newFruitPos(fruit); // gen new fruit pos
-		fruitMesh = fruit->getMesh(); // set fruit mesh with updated verts based on new pos
-		whichFruit = (rand() % 2) + 1; // set which fruit to spawn
-
-		addScoreDot(); // add score
-	}
 
-	if (collisionManager.isColliding(snek[1], bigFruit) && whichFruit == 2) { // check for collision with big fruit
-		addSnekPart(); // add length to snek x2
-		addSnekPart();
-		newFruitPos(bigFruit); // gen new fruit pos
-		bigFruitMesh = bigFruit->getMesh(); // set fruit mesh with updated verts based on new pos
-		whichFruit = (rand() % 2) + 1; // set which fruit to spawn
+		// move, spawn and remove entities to match what the sim just did
+		myWorld.onStep(*mySim, result);
 
-		addScoreDot();// add score x2
-		addScoreDot();
-	}
+		// checkpoints are mostly just the cells that changed, so taking one every second is cheap
+		uint64_t sessionTicks = myReplay.getTickCount();
+		if (myPlayback == nullptr && sessionTicks % CHECKPOINT_TICKS == 0) {
+			myCheckpoints.capture(*mySim, sessionTicks);
+		}
+		if (myPlayback == nullptr && sessionTicks % AUTOSAVE_TICKS == 0) {
+			SaveCheckpoints();
+		}
 
-	for (int i = 0; i <= dead.size() - 1; i++) { // if colliding with obstacle, reset game
-		if (collisionManager.isColliding(snek[1], dead[i])) {
-			resetGame();
+		// let the viewer know whether the game played out the way it was recorded
+		if (myPlayback != nullptr && myPlaybackCursor->done()) {
+			if (myPlayback->getChecksum() != 0 && myPlayback->getChecksum() != mySim->getChecksum()) {
+				LOG_WARN("Replay finished, but desynced from the recording");
+			}
+			else {
+				LOG_INFO("Replay finished");
+			}
 		}
 	}
 }
 
-void Game::addSnekPart() {
-	glm::vec3 temp = glm::vec3(0, 0, 0);
-
-	switch (snek[snek.size() - 1]->getDirection()) { // find difference in position with last snek part based on direction
-	case 0:
-		temp = glm::vec3(0, -0.05, 0);
-		break;
-	case 1:
-		temp = glm::vec3(0, 0.05, 0);
-		break;
-	case 2:
-		temp = glm::vec3(0.05, 0, 0);
-		break;
-	case 3:
-		temp = glm::vec3(-0.05, 0, 0);
-		break;
+void Game::Draw(float deltaTime) {
+	// Offscreen, everything is drawn into the capture framebuffer instead
+	if (myCapture != nullptr) {
+		myCapture->Bind();
 	}
 
-	// add snek part to vector
- 	snek.push_back(new Object(glm::vec3(snek[snek.size() - 1]->getPosition().x, snek[snek.size() - 1]->getPosition().y, 0) + temp, glm::vec4(0, 0, 1, 1), snek[snek.size() - 1]->getDirection()));
-	snekMeshes.push_back(snek[snek.size()-1]->getMesh()); // add mesh to vector
-}
-
-void Game::addScoreDot() {
-	this->score += 1; // increase score
-	glm::vec3 startPos = glm::vec3(-0.95, 0.95, 0); // define starting pos for score dots on screen
-	startPos.x += ((this->score - 1) * (0.0125 + 0.05)); // determine current score dot position
-
-	scoreDot.push_back(new ScoreDot(startPos)); // add new score dot obj to vector
-	scoreDotMesh.push_back(scoreDot[scoreDot.size() - 1]->getMesh()); // add mesh to vector
-}
-
-void Game::Draw(float deltaTime) {
 	// Clear our screen every frame
 	glClearColor(myClearColor.x, myClearColor.y, myClearColor.z, myClearColor.w);
 	glClear(GL_COLOR_BUFFER_BIT);
 
-	myShader->Bind(); // bind shader
+	// collect an instance record for everything on screen
+	myQuadRenderer->Begin();
 
-	// draw all meshes
-	for (int i = 1; i < snekMeshes.size(); i++) {
-		snekMeshes[i]->Draw();
-	}
+	// how far we are towards the next tick, so the snek moves smoothly instead of once every tick
+	float alpha = (float)myTimestep.getAlpha();
 
-	if (whichFruit == 1) {
-		fruitMesh->Draw();
-	}
-	else if (whichFruit == 2) {
-		bigFruitMesh->Draw();
-	}
+	// every entity on screen, with the ones that moved last tick slid part of the way there
+	myWorld.buildBatch(*myQuadRenderer, alpha);
 
-	for (int i = 0; i <= dead.size() - 1; i++) {
-		deadMesh[i]->Draw();
-	}
+	myShader->Update(); // swap to the rebuilt shader if one of its files was edited and it has finished compiling
+	myShader->Bind(); // bind shader
 
-	for (int i = 0; i < scoreDotMesh.size(); i++) {
-		scoreDotMesh[i]->Draw();
-	}
+	// draw the whole batch in one call
+	myQuadRenderer->Flush();
 }
 
 void Game::DrawGui(float deltaTime) {
@@ -460,100 +747,9 @@ void Game::DrawGui(float deltaTime) {
 	// Draw a formatted text line
 	ImGui::Text("Time: %f", glfwGetTime());
 	ImGui::End();
-}
-
-void Game::resetGame()
-{
-	// clear snek obj and snek mesh vectors
-	snek.clear();
-	snekMeshes.clear();
-	snek.push_back(new Object(glm::vec3(0, 0, 0), glm::vec4(0, 0, 1, 1), 0)); // add head
-	snekMeshes.push_back(snek[0]->getMesh()); // add head mesh
-	addSnekPart(); // add snek part since 0th index is invisible andd unused
-
-	newFruitPos(fruit); // gen random fruit pos
-	fruitMesh = fruit->getMesh(); // update mesh with new verts based on pos
-
-	newFruitPos(bigFruit); // gen random big fruit pos
-	bigFruitMesh = bigFruit->getMesh(); // update mesh with new verts based on pos
-
-	dead.clear(); // clear obstacle vector
-	deadMesh.clear(); // clear mesh vector
-	dead.push_back(new Object(glm::vec3(0, 0, 0), glm::vec4(0, 1, 0, 1), -1)); // add new obstacle obj
-	newFruitPos(dead[0]); // gen new obstacle pos
-	deadMesh.push_back(dead[0]->getMesh()); // update obstacle mesh verts based on new pos
-
-	scoreDot.clear(); // clear score dot vector
-	scoreDotMesh.clear(); // clear score dot mesh vector
-	this->score = 0; // reset score
-}
-
-void Game::newFruitPos(Object* obj)
-{
-	bool intersecting = true; // is the new position on another object
-
-	float x = 0.4, y = 0.4, z = 0;
-	float possibleNumbers[39] = {
-								 //Negative -1 - 0
-								 -0.95, -0.9, -0.85, -0.8, -0.75, -0.7, -0.65, -0.6, -0.55, -0.5,
-								 -0.45, -0.4, -0.35, -0.3, -0.25, -0.2, -0.15, -0.1, -0.05, 0.0,
-								 //Positive 0.05 - 1
-								 0.95, 0.9, 0.85, 0.8, 0.75, 0.7, 0.65, 0.6, 0.55, 0.5,
-								 0.45, 0.4, 0.35, 0.3, 0.25, 0.2, 0.15, 0.1, 0.05 
-								};
-	
-	while (intersecting) { // check to make sure we arent spawing in the snake body or on obstacles/fruit
-		int temp = rand() % 38;
-		x = possibleNumbers[temp];
-
-		temp = rand() % 38;
-		y = possibleNumbers[temp];
-
-		bool iSnek = false; // intersecting snek
-		bool iDead = false; // intersecting obstacle
-		bool iFruit = false; // intersecting fruit
-		bool iBigFruit = false; // intersecting big fruit
-
-		for (int i = 0; i < snek.size() - 1; i++) {
-			if (snek[i]->getPosition().x != x && snek[i]->getPosition().y != y) {
-				iSnek = false;
-			}
-			else {
-				iSnek = true;
-			}
-		}
-		for (int i = 0; i < dead.size(); i++) {
-			if (dead[i]->getPosition().x != x && dead[i]->getPosition().y != y) {
-				iDead = false;
-			}
-			else {
-				iDead = true;
-			}
-		}
-		if (whichFruit == 1) { // no need to check if intersecting fruit when only big fruit present
-			if (this->fruit->getPosition().x != x && this->fruit->getPosition().y != y) {
-				iFruit = false;
-			}
-			else {
-				iFruit = true;
-			}
-		}
-		if (whichFruit == 2) { // no need to check if intersecting big fruit when only fruit present
-			if (this->bigFruit->getPosition().x != x && this->bigFruit->getPosition().y != y) {
-				iBigFruit = false;
-			}
-			else {
-				iBigFruit = true;
-			}
-		}
-
-		if (!iSnek && !iDead && !iFruit && !iBigFruit) { // if not intersecting any of the above, intersecting false exit loop
-			intersecting = false;
-		}
-	}
-	
-
-	obj->setPosition(glm::vec3(x, y, z)); // update the position to new randomly generated one
-	obj->updateMesh(); // update the verts in the mesh
-}
-
+
+	// Frame timings and counters
+	if (myShowProfiler) {
+		Profiler::DrawGui();
+	}
+}
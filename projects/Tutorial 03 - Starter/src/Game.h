@@ -2,23 +2,61 @@
 
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
+#include <condition_variable>
 #include <iostream>
+#include <mutex>
+#include <thread>
 
 #include "GLM/glm.hpp"
 
 #include "Mesh.h"
+#include "QuadRenderer.h"
 #include "Shader.h"
 #include <vector>
-#include "Object.h"
-#include "Collision.h"
+#include "SnakeSim.h"
+#include "FixedTimestep.h"
+#include "Replay.h"
+#include "Checkpointer.h"
+#include "SnakeWorld.h"
+#include "FrameCapture.h"
 
 class Game {
 public:
+	// How frames are paced
+	enum class FrameMode {
+		VSync, // wait for the monitor's refresh when presenting
+		Capped, // sleep until the frame cap has been reached
+		Uncapped // render as fast as we can
+	};
+
 	Game();
 	~Game();
 
 	void Run();
 
+	void SetSeed(uint64_t seed); // seed for every random decision in the game, random by default. Ignored while watching a replay
+	uint64_t GetSeed() const { return mySeed; }
+	void SetBoardSize(int width, int height); // board size in cells, 39x39 by default. Throws if it is out of range for SnakeSim, ignored while watching a replay
+	void SetTickRate(double ticksPerSecond); // how many times per second the sim is stepped, 10 by default. Throws if not above 0
+	void SetMaxCatchUpSteps(int maxSteps); // how many sim steps a single slow frame is allowed to catch up on, throws if less than 1
+	void SetFrameMode(FrameMode mode, double frameCap = 60.0); // vsync by default, frameCap is only used by FrameMode::Capped
+	void SetReplayPath(const std::string& path) { myReplayPath = path; } // where the session is recorded to on exit, empty to not record
+	void PlayReplay(const std::string& path); // watch a recorded session in real time instead of playing, throws if it can't be read
+
+	// Which API GLFW creates the context with, for software GL on machines with no GPU
+	enum class ContextApi {
+		Native, // WGL or GLX
+		Egl,
+		OsMesa // Mesa's off-screen software renderer
+	};
+
+	// Render into a width x height offscreen framebuffer in a hidden window, instead of to the screen. Every frame
+	// advances exactly 1/60th of a second, so the same seed or replay always renders the same frames. The game closes
+	// after frameCount frames, or with 0 once the replay being watched has finished (or never, if there isn't one)
+	void SetOffscreen(int width, int height, uint64_t frameCount = 0, ContextApi api = ContextApi::Native);
+	// Write every Nth offscreen frame to directory as a PNG, nothing is written by default
+	void SetCapture(const std::string& directory, int every = 1);
+
 	// called when a key has been pressed
 	void KeyPressed(GLFWwindow* window, int key);
 
@@ -35,21 +73,24 @@ protected:
 	void LoadContent(); // load in all mesh types and link shader
 	void UnloadContent(); // null
 
-	void InitImGui(); // unused for this project
-	void ShutdownImGui(); // unused for this project
+	void InitImGui(); // set up ImGui for the debug windows
+	void ShutdownImGui();
 
-	void ImGuiNewFrame(); // unused for this project
-	void ImGuiEndFrame(); // unused for this project
+	void ImGuiNewFrame();
+	void ImGuiEndFrame();
 
-	void Update(float deltaTime); // check collision, change snek dir & update pos, fruit and obstacle spawn timer
-	void CollisionCheck(); // collision check logic, called by Update()
-	void Draw(float deltaTime); // set clear color and clear, bind shader & draw meshes 
-	void addSnekPart(); // called when adding a snek part when score increases
-	void addScoreDot(); // called when score increases
-	void DrawGui(float deltaTime); // unused for this project
+	void Update(float deltaTime); // step the sim every tick with the latest input, keep the score dots in sync
+	void Draw(float deltaTime); // set clear color and clear, bind shader & draw all objects as one instanced batch
 
-	void resetGame(); // called upon death (run into yourself or an obstacle)
-	void newFruitPos(Object* obj); // set position of passed obj to new random position and update verts in mesh, used for fruits and obstacles
+	void ApplyFrameMode(); // set the swap interval for the current frame mode
+	void LimitFrameRate(double frameStart); // sleep off the rest of the frame when the frame rate is capped
+	void DrawGui(float deltaTime); // the debug windows, including the profiler
+	void SaveReplay(); // write the recorded session out to myReplayPath, if there is one
+	void Restart(); // start a new game from mySeed on a board of the current size, and start recording over
+	void Rewind(); // go back to the last checkpoint that is at least a moment ago
+	void SaveCheckpoints(); // hand a copy of the checkpoint history to the autosave thread, to be written to myAutosavePath
+	void LoadCheckpoints(); // pick up from the newest checkpoint in myAutosavePath
+	void DumpTrace(); // write the recorded spans to trace.json, does nothing unless built with ENABLE_TRACING
 
 private:
 	// Stores the main window that the game is running in
@@ -59,28 +100,61 @@ private:
 	// Stores the title of the game's window
 	char        myWindowTitle[32];
 
-	Collision collisionManager;
-
-	std::vector<Object*> snek; // vector of snek parts, head at i = 1. i = 0 unused and not drawn
-	Object* fruit; // red, increases score by 1 when collided with
-	Object* bigFruit; // yellow, increases score by two when collided with
-	std::vector<Object*> dead; // green, resets game andscore when collided with
-	std::vector<ScoreDot*> scoreDot; // white, represents score
-
-	float timer = 0; // update timer
-	float obTimer = 0; // obstacle update timer
-	float count = 0; // amount of times timer has hit 0.1
-	float obCount = 0; // amount of times obTimer has hit 10. Should be equal to amount of obstacles on screen
-	int whichFruit = 1; //1 reg fruit, 2 big fruit
-	int score = 0; // player score
-
-	// shared pointers to our meshes
-	std::vector<Mesh_sptr> snekMeshes;
-	Mesh_sptr fruitMesh;
-	Mesh_sptr bigFruitMesh;
-	std::vector<Mesh_sptr> deadMesh;
-	std::vector<Mesh_sptr> scoreDotMesh;
-	
+	// The game rules and state (snek, fruits, obstacles and score)
+	SnakeSim_sptr mySim;
+	// The seed the sim was started from, the same seed and inputs always play out the same way
+	uint64_t mySeed;
+	int myBoardWidth = SnakeSim::DEFAULT_SIZE, myBoardHeight = SnakeSim::DEFAULT_SIZE;
+
+	// An entity for everything we draw (snek, fruit, obstacles and score dots), kept in step with the sim
+	SnakeWorld myWorld;
+
+	// Turns frame time into fixed length sim ticks
+	FixedTimestep myTimestep;
+	// How we are pacing our frames, and the target frame rate for FrameMode::Capped
+	FrameMode myFrameMode = FrameMode::VSync;
+	double myFrameCap = 60.0;
+
+	int myInput = -1; // direction from the latest key press, handed to the sim on the next tick. -1 keeps going straight
+
+	// Every tick's input is recorded, and written out to myReplayPath when the game closes
+	Replay myReplay;
+	std::string myReplayPath = "last.replay";
+	// The replay being watched and how far through it we are, null when the player is in control
+	Replay_sptr myPlayback;
+	std::unique_ptr<Replay::Cursor> myPlaybackCursor;
+
+	// A checkpoint is taken every CHECKPOINT_TICKS ticks for rewinding, and the history is autosaved every AUTOSAVE_TICKS
+	static constexpr uint64_t CHECKPOINT_TICKS = 10;
+	static constexpr uint64_t AUTOSAVE_TICKS = 300;
+	Checkpointer myCheckpoints{ 30, 600 }; // a full snapshot every 3 seconds, and up to 10 minutes of history
+	std::string myAutosavePath = "autosave.sav";
+
+	// Writing the history out takes far longer than a tick, so autosaves are written by a worker thread from a copy
+	void __AutosaveLoop();
+	std::thread myAutosaver;
+	std::mutex myAutosaveMutex; // guards everything below
+	std::condition_variable myAutosaveChanged; // signalled when a copy is handed over or written, or the autosaver is stopped
+	Checkpointer myAutosaveCopy; // the newest history handed over, waiting to be written
+	std::string myAutosaveCopyPath;
+	bool myAutosavePending = false; // myAutosaveCopy hasn't been picked up by the autosaver yet
+	bool myAutosaving = false; // the autosaver is writing a copy out
+	bool myStopAutosaving = false;
+
+	bool myShowProfiler = true; // whether the profiler window is shown, toggled with F3
+
+	// Set when rendering offscreen instead of to the window, created along with the context
+	FrameCapture_sptr myCapture;
+	bool myOffscreen = false;
+	int myOffscreenWidth = 800, myOffscreenHeight = 800;
+	uint64_t myOffscreenFrames = 0; // frames to render before closing, 0 to stop with the replay
+	ContextApi myContextApi = ContextApi::Native;
+	std::string myCaptureDirectory;
+	int myCaptureEvery = 1;
+
+	// Draws every square on screen with a single instanced draw call
+	QuadRenderer_sptr myQuadRenderer;
+
 
 	// A shared pointer to our shader
 	Shader_sptr myShader;
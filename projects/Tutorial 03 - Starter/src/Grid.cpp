@@ -0,0 +1,59 @@
+#include "Grid.h"
+#include "SnakeRules.h"
+
+#include <algorithm>
+
+Grid::Grid(int width, int height) :
+	width(width),
+	height(height),
+	cells((uint32_t)width * height)
+{
+	freeCells.reset(cells.size());
+}
+
+void Grid::set(glm::ivec2 cell, CellType type)
+{
+	uint32_t i = index(cell);
+
+	// only touch the empty cell index when a cell goes from empty to taken, or back
+	if (type == CellType::Empty) {
+		freeCells.insert(i);
+	}
+	else {
+		freeCells.remove(i);
+	}
+
+	cells.set(i, type);
+}
+
+void Grid::clear()
+{
+	cells.reset();
+	freeCells.reset(cells.size());
+}
+
+void Grid::copyCells(CellType* out) const
+{
+	std::fill(out, out + cells.size(), CellType::Empty);
+	cells.forEachWritten([out](uint32_t i, CellType type) {
+		out[i] = type;
+	});
+}
+
+void Grid::restore(const std::vector<uint32_t>& slots, const std::vector<uint32_t>& order, uint32_t emptyCount)
+{
+	cells.reset();
+	freeCells.restore(cells.size(), slots, order, emptyCount);
+}
+
+glm::ivec2 Grid::getEmptyCell(uint32_t i) const
+{
+	uint32_t cell = freeCells[i];
+	return glm::ivec2(cell % width, cell / width);
+}
+
+glm::ivec2 Grid::wrap(glm::ivec2 cell) const
+{
+	// loop around the screen
+	return glm::ivec2(SnakeRules::wrap(cell.x, width), SnakeRules::wrap(cell.y, height));
+}
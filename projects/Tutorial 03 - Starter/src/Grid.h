@@ -0,0 +1,54 @@
+#pragma once
+
+#include <GLM/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+#include "FreeCellSet.h"
+#include "PagedArray.h"
+
+// What is sitting in a cell of the board
+enum class CellType : uint8_t {
+	Empty = 0,
+	Snake,
+	Obstacle,
+	Fruit
+};
+
+// An integer cell grid with one entry per cell. The sim keeps it up to date as things move, so checking what the
+// snake's head ran into is a single lookup no matter how long the snake is. The grid also keeps an index of all the
+// empty cells, so that things can be spawned on a random empty cell in constant time. Cells are paged in as they are
+// written to, so a huge board only costs as much as the part of it that has been played on
+class Grid {
+public:
+	Grid(int width, int height); // creates an empty grid
+
+	CellType get(glm::ivec2 cell) const { return cells.get(index(cell)); } // what is in the given cell
+	void set(glm::ivec2 cell, CellType type); // set what is in the given cell, keeping the empty cell index up to date
+	bool isEmpty(glm::ivec2 cell) const { return get(cell) == CellType::Empty; }
+
+	void clear(); // empty every cell, only touching the ones that have been written to
+	void reserve(uint32_t cellCount) { cells.reserve(cellCount); freeCells.reserve(cellCount); } // room to write that many cells without allocating
+
+	void copyCells(CellType* out) const; // write every cell out row major, out must hold width * height cells
+
+	// save and restore the order of the empty cell index, see FreeCellSet::save(). Restoring also empties every cell,
+	// and the taken ones have to be set again after, which won't touch the index since it already has them as taken
+	void saveFreeOrder(std::vector<uint32_t>& slots, std::vector<uint32_t>& order) const { freeCells.save(slots, order); }
+	void restore(const std::vector<uint32_t>& slots, const std::vector<uint32_t>& order, uint32_t emptyCount);
+
+	uint32_t getEmptyCount() const { return freeCells.size(); } // number of empty cells
+	glm::ivec2 getEmptyCell(uint32_t i) const; // the i'th empty cell, in no particular order. i must be less than getEmptyCount()
+
+	glm::ivec2 wrap(glm::ivec2 cell) const; // wrap a cell that is at most one step off the board back onto the other side
+
+	int getWidth() const { return width; }
+	int getHeight() const { return height; }
+
+private:
+	uint32_t index(glm::ivec2 cell) const { return (uint32_t)cell.y * width + cell.x; }
+
+	int width, height;
+	PagedArray<CellType> cells; // row major, width * height entries
+	FreeCellSet freeCells; // indices of every empty cell
+};
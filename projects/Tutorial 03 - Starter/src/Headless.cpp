@@ -0,0 +1,119 @@
+#include "Headless.h"
+#include "Logging.h"
+#include "Replay.h"
+#include "SimRunner.h"
+#include "SnakeBatch.h"
+#include "SnakeRules.h"
+#include "SnakeSim.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <vector>
+
+int FastForward(int count, char** paths) {
+	SnakeSim sim;
+	uint64_t totalTicks = 0;
+	int desyncs = 0;
+
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < count; i++) {
+		try {
+			ReplayResult result = Replay::readFile(paths[i]).play(sim);
+			totalTicks += result.ticks;
+			LOG_INFO("{}: {} ticks, best score {}, {} deaths{}", paths[i], result.ticks, result.bestScore, result.deaths,
+				result.matches ? "" : " DESYNC");
+			desyncs += !result.matches;
+		}
+		catch (const std::exception& e) {
+			LOG_ERROR(e.what());
+			desyncs++;
+		}
+	}
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	LOG_INFO("Played {} replays, {} ticks in {:.3f}s ({:.0f} ticks/s), {} failed", count, totalTicks, seconds,
+		seconds > 0.0 ? totalTicks / seconds : 0.0, desyncs);
+	return desyncs;
+}
+
+void RunEpisodes(uint32_t episodeCount, uint32_t threadCount, uint64_t maxTicks, uint64_t firstSeed, int width, int height) {
+	std::vector<uint64_t> seeds(episodeCount);
+	for (uint32_t i = 0; i < episodeCount; i++) {
+		seeds[i] = firstSeed + i;
+	}
+
+	SimRunner runner(threadCount, width, height);
+	RunStats stats = runner.run(seeds, maxTicks);
+
+	int bestScore = 0, deaths = 0, wins = 0;
+	for (const EpisodeResult& episode : stats.episodes) {
+		bestScore = std::max(bestScore, episode.score);
+		deaths += episode.died;
+		wins += episode.won;
+	}
+
+	LOG_INFO("Played {} episodes of {}x{} on {} threads, {} ticks in {:.3f}s ({:.0f} ticks/s)", episodeCount, width,
+		height, runner.getThreadCount(), stats.totalTicks, stats.seconds, stats.ticksPerSecond);
+	LOG_INFO("Best score {}, {} deaths, {} wins", bestScore, deaths, wins);
+}
+
+int CheckBatch(uint32_t gameCount, uint64_t ticks, uint64_t firstSeed, int width, int height) {
+	// the batch derives game i's stream from firstSeed + i the same way a sim does from its seed
+	SnakeBatch batch(gameCount, firstSeed, width, height);
+	std::vector<SnakeSim> sims;
+	sims.reserve(gameCount);
+	for (uint32_t game = 0; game < gameCount; game++) {
+		sims.emplace_back(firstSeed + game, width, height);
+	}
+
+	// the actions come from a seed none of the games use, so they don't follow the spawns
+	Random rng(firstSeed + gameCount);
+	std::vector<int8_t> actions(gameCount);
+	std::vector<uint8_t> diverged(gameCount, 0);
+	std::vector<CellType> simCells(batch.getObservationSize());
+	std::vector<uint8_t> batchCells(batch.getObservationSize() * gameCount);
+
+	auto start = std::chrono::steady_clock::now();
+	for (uint64_t tick = 1; tick <= ticks; tick++) {
+		for (int8_t& action : actions) {
+			action = (int8_t)((int)rng.below(5) - 1);
+		}
+
+		batch.stepAll(actions.data());
+		batch.writeObservations(batchCells.data());
+
+		for (uint32_t game = 0; game < gameCount; game++) {
+			if (diverged[game]) {
+				continue;
+			}
+
+			SnakeSim& sim = sims[game];
+			StepResult result = sim.step(actions[game]);
+			float reward = result.died ? SnakeRules::DEATH_REWARD : (float)result.scoreGained;
+			sim.getGrid().copyCells(simCells.data());
+
+			bool matches =
+				memcmp(simCells.data(), &batchCells[game * batch.getObservationSize()], batch.getObservationSize()) == 0 &&
+				sim.getSnek()[0].x == batch.getHeadX()[game] && sim.getSnek()[0].y == batch.getHeadY()[game] &&
+				sim.getSnek().size() == batch.getLength(game) &&
+				sim.getDirection() == batch.getDirections()[game] &&
+				sim.getScore() == batch.getScores()[game] &&
+				reward == batch.getRewards()[game] &&
+				(result.died || result.won) == (batch.getDones()[game] != 0);
+			if (!matches) {
+				LOG_WARN("Game {} (seed {}) differs from SnakeSim on tick {}", game, firstSeed + game, tick);
+				diverged[game] = 1;
+			}
+		}
+	}
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	int failed = 0;
+	for (uint8_t game : diverged) {
+		failed += game;
+	}
+	LOG_INFO("Checked {} batched games of {}x{} against SnakeSim for {} ticks in {:.3f}s, {} differed", gameCount, width,
+		height, ticks, seconds, failed);
+	return failed;
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+
+// The parts of the game that run with no window or GL context, shared by the game's command line and the Headless
+// build (which has no GL or GLFW at all). Both log through Logger, so it must be initialized first
+
+// Plays every replay as fast as the sim will go. Returns how many of them desynced or couldn't be read
+int FastForward(int count, char** paths);
+
+// Plays episodeCount random games on a SimRunner, from seeds firstSeed, firstSeed + 1... on width x height boards, and
+// logs how fast it went and how the games turned out. threadCount 0 uses every hardware thread. Throws if the board
+// size is out of range
+void RunEpisodes(uint32_t episodeCount, uint32_t threadCount, uint64_t maxTicks, uint64_t firstSeed, int width, int height);
+
+// Steps a SnakeBatch of gameCount games next to a SnakeSim for each of them, with the same seeds (firstSeed, firstSeed + 1...)
+// and the same random actions, and compares their boards, heads, scores, rewards and dones after every tick. Returns how
+// many of the games played out differently. Throws if the board size is out of range
+int CheckBatch(uint32_t gameCount, uint64_t ticks, uint64_t firstSeed, int width, int height);
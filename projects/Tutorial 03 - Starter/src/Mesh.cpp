@@ -1,4 +1,5 @@
 #include "Mesh.h"
+#include "Profiler.h"
 
 Mesh::Mesh(Vertex* vertices, size_t numVerts, uint32_t* indices, size_t numIndices) {
 	myIndexCount = numIndices;
@@ -11,6 +12,7 @@ Mesh::Mesh(Vertex* vertices, size_t numVerts, uint32_t* indices, size_t numIndic
 
 	// Create 2 buffers, 1 for vertices and the other for indices
 	glCreateBuffers(2, myBuffers);
+	Profiler::CountGlObjects(3);
 
 	// Bind and buffer our vertex data
 	glBindBuffer(GL_ARRAY_BUFFER, myBuffers[0]);
@@ -51,4 +53,13 @@ void Mesh::Draw() {
 	glBindVertexArray(myVao);
 	// Draw all of our vertices as triangles, our indexes are unsigned ints (uint32_t)
 	glDrawElements(GL_TRIANGLES, myIndexCount, GL_UNSIGNED_INT, nullptr);
+	Profiler::CountDrawCall();
+}
+
+void Mesh::DrawInstanced(size_t instanceCount) {
+	// Bind the mesh
+	glBindVertexArray(myVao);
+	// Draw every instance of our triangles at once
+	glDrawElementsInstanced(GL_TRIANGLES, myIndexCount, GL_UNSIGNED_INT, nullptr, instanceCount);
+	Profiler::CountDrawCall();
 }
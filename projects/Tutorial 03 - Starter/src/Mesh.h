@@ -20,6 +20,11 @@ public:
 
 	// Draws this mesh
 	void Draw();
+	// Draws instanceCount copies of this mesh in a single draw call, per-instance attributes must already be set up on the VAO
+	void DrawInstanced(size_t instanceCount);
+
+	// Gets the GL handle for this mesh's Vertex Array Object, so that extra attributes can be attached to it
+	GLuint GetVao() const { return myVao; }
 
 private:
 	// Our GL handle for the Vertex Array Object
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+// What an entry of a PagedArray holds until it is first written, T's default value
+template <typename T>
+struct FillDefault {
+	T operator()(uint32_t) const { return T(); }
+};
+
+// What an entry of a PagedArray holds until it is first written, its own index
+struct FillIndex {
+	uint32_t operator()(uint32_t index) const { return index; }
+};
+
+// A fixed size array that only stores the pages of entries that have been written, every other entry reads as what
+// Fill gives for its index. On a huge board almost every cell is never touched in a game, so this keeps memory and
+// the cost of starting over proportional to what has changed instead of to the size of the board. Pages are handed
+// out from one contiguous pool that reset() rewinds without freeing, so once it has grown a game never allocates
+template <typename T, typename Fill = FillDefault<T>>
+class PagedArray {
+public:
+	static constexpr uint32_t PAGE_BITS = 8;
+	static constexpr uint32_t PAGE_SIZE = 1u << PAGE_BITS;
+
+	PagedArray(uint32_t size = 0) { resize(size); }
+
+	// sets the number of entries, and forgets everything that was written
+	void resize(uint32_t size) {
+		count = size;
+		// in 64 bits, a size within a page of 2^32 would wrap around to no pages at all
+		pageOf.assign((size_t)(((uint64_t)size + PAGE_SIZE - 1) / PAGE_SIZE), NO_PAGE);
+		storage.clear();
+		owners.clear();
+	}
+
+	// makes room for the pages holding the given number of entries, so writing that many pages never allocates
+	void reserve(uint32_t entries) {
+		size_t pages = ((size_t)std::min(entries, count) + PAGE_SIZE - 1) / PAGE_SIZE;
+		storage.reserve(pages * PAGE_SIZE);
+		owners.reserve(pages);
+	}
+
+	// forgets everything that was written, only touching the pages that were
+	void reset() {
+		for (uint32_t page : owners) {
+			pageOf[page] = NO_PAGE;
+		}
+		storage.clear();
+		owners.clear();
+	}
+
+	T get(uint32_t i) const {
+		uint32_t page = pageOf[i >> PAGE_BITS];
+		return page == NO_PAGE ? Fill()(i) : storage[(size_t)page * PAGE_SIZE + (i & (PAGE_SIZE - 1))];
+	}
+
+	void set(uint32_t i, T value) {
+		uint32_t& page = pageOf[i >> PAGE_BITS];
+		if (page == NO_PAGE) {
+			page = __Allocate(i >> PAGE_BITS);
+		}
+		storage[(size_t)page * PAGE_SIZE + (i & (PAGE_SIZE - 1))] = value;
+	}
+
+	uint32_t size() const { return count; }
+	uint32_t getPageCount() const { return (uint32_t)owners.size(); } // number of pages that have been written to
+
+	// calls f(index, value) for every entry of every page that has been written to, in index order
+	template <typename F> void forEachWritten(F f) const {
+		for (uint32_t page : owners) {
+			const T* entries = &storage[(size_t)pageOf[page] * PAGE_SIZE];
+			uint32_t first = page << PAGE_BITS;
+			uint32_t last = (uint32_t)std::min((uint64_t)first + PAGE_SIZE, (uint64_t)count);
+			for (uint32_t i = first; i < last; i++) {
+				f(i, entries[i - first]);
+			}
+		}
+	}
+
+private:
+	static constexpr uint32_t NO_PAGE = 0xFFFFFFFFu;
+
+	// gives a page its storage, filled in with what it read as before
+	uint32_t __Allocate(uint32_t page) {
+		uint32_t slot = (uint32_t)(storage.size() / PAGE_SIZE);
+		uint32_t first = page << PAGE_BITS;
+		for (uint32_t i = 0; i < PAGE_SIZE; i++) {
+			storage.push_back(Fill()(first + i));
+		}
+
+		// kept sorted so forEachWritten goes in index order. Pages are only allocated the first time a game touches them
+		owners.insert(std::upper_bound(owners.begin(), owners.end(), page), page);
+		return slot;
+	}
+
+	uint32_t count = 0;
+	std::vector<uint32_t> pageOf; // where each page is in storage, NO_PAGE if it hasn't been written to
+	std::vector<T> storage; // PAGE_SIZE entries for every written page, in the order they were written
+	std::vector<uint32_t> owners; // the written pages, ascending
+};
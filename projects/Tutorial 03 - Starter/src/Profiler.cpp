@@ -0,0 +1,180 @@
+#include "Profiler.h"
+#include "AllocCounter.h"
+#include "Logging.h"
+
+#include <glad/glad.h>
+#include <algorithm>
+#include <cstdio>
+#include <string>
+
+#include "imgui.h"
+
+namespace {
+	constexpr int METRIC_COUNT = (int)Profiler::Metric::Count;
+	// GPU results take a few frames to come back, so we keep a few queries in flight
+	constexpr int GPU_QUERIES = 4;
+
+	const char* NAMES[METRIC_COUNT] = {
+		"Frame", "Update", "Sim step", "Draw", "Upload", "Gui", "GPU draw", "Draw calls", "GL objects", "Allocations"
+	};
+	const bool IS_TIME[METRIC_COUNT] = {
+		true, true, true, true, true, true, true, false, false, false
+	};
+
+	using Clock = std::chrono::steady_clock;
+
+	double current[METRIC_COUNT]; // the frame that is in progress
+	double latest[METRIC_COUNT]; // the last finished frame
+	float history[METRIC_COUNT][Profiler::HISTORY];
+	int historyCursor = 0; // where the next frame goes in the history, which is also the oldest frame
+
+	Clock::time_point frameStart;
+	uint64_t frameAllocStart = 0;
+
+	// sums and peaks since the last summary was logged
+	double intervalSum[METRIC_COUNT];
+	double intervalMax[METRIC_COUNT];
+	int intervalFrames = 0;
+	double exportInterval = 5.0;
+	Clock::time_point lastExport = Clock::now();
+
+	GLuint gpuQueries[GPU_QUERIES];
+	bool gpuPending[GPU_QUERIES]; // issued, but the result hasn't been read yet
+	int gpuNext = 0; // which query the next GPU timer uses
+	bool gpuRunning = false;
+	bool gpuReady = false;
+	double gpuLatest = 0.0; // the most recent GPU time that came back
+}
+
+Profiler::Scope::~Scope() {
+	Add(myMetric, std::chrono::duration<double, std::milli>(Clock::now() - myStart).count());
+}
+
+void Profiler::InitGpu() {
+	glCreateQueries(GL_TIME_ELAPSED, GPU_QUERIES, gpuQueries);
+	std::fill(gpuPending, gpuPending + GPU_QUERIES, false);
+	gpuReady = true;
+}
+
+void Profiler::ShutdownGpu() {
+	if (gpuReady) {
+		glDeleteQueries(GPU_QUERIES, gpuQueries);
+		gpuReady = false;
+	}
+}
+
+void Profiler::BeginFrame() {
+	std::fill(current, current + METRIC_COUNT, 0.0);
+	frameStart = Clock::now();
+	frameAllocStart = AllocCounter::GetThreadCount();
+}
+
+void Profiler::EndFrame() {
+	current[(int)Metric::Frame] = std::chrono::duration<double, std::milli>(Clock::now() - frameStart).count();
+	current[(int)Metric::Allocations] = (double)(AllocCounter::GetThreadCount() - frameAllocStart);
+
+	// pick up any GPU timings that have finished, without waiting on the ones that haven't
+	if (gpuReady) {
+		for (int i = 0; i < GPU_QUERIES; i++) {
+			if (!gpuPending[i]) {
+				continue;
+			}
+			GLint available = 0;
+			glGetQueryObjectiv(gpuQueries[i], GL_QUERY_RESULT_AVAILABLE, &available);
+			if (available) {
+				GLuint64 nanoseconds = 0;
+				glGetQueryObjectui64v(gpuQueries[i], GL_QUERY_RESULT, &nanoseconds);
+				gpuLatest = nanoseconds / 1000000.0;
+				gpuPending[i] = false;
+			}
+		}
+	}
+	current[(int)Metric::GpuDraw] = gpuLatest;
+
+	for (int i = 0; i < METRIC_COUNT; i++) {
+		latest[i] = current[i];
+		history[i][historyCursor] = (float)current[i];
+		intervalSum[i] += current[i];
+		intervalMax[i] = std::max(intervalMax[i], current[i]);
+	}
+	historyCursor = (historyCursor + 1) % HISTORY;
+	intervalFrames++;
+
+	double sinceExport = std::chrono::duration<double>(Clock::now() - lastExport).count();
+	if (exportInterval <= 0.0 || sinceExport < exportInterval) {
+		return;
+	}
+
+	// one line with the average and peak of everything over the interval
+	std::string summary = "Profile (" + std::to_string(intervalFrames) + " frames):";
+	for (int i = 0; i < METRIC_COUNT; i++) {
+		char entry[96];
+		snprintf(entry, sizeof(entry), IS_TIME[i] ? " %s %.3f/%.3fms" : " %s %.1f/%.0f", NAMES[i],
+			intervalSum[i] / intervalFrames, intervalMax[i]);
+		summary += entry;
+	}
+	LOG_INFO(summary);
+
+	std::fill(intervalSum, intervalSum + METRIC_COUNT, 0.0);
+	std::fill(intervalMax, intervalMax + METRIC_COUNT, 0.0);
+	intervalFrames = 0;
+	lastExport = Clock::now();
+}
+
+void Profiler::BeginGpuTimer() {
+	// if this query still hasn't come back, skip timing this frame rather than stalling on it
+	if (!gpuReady || gpuRunning || gpuPending[gpuNext]) {
+		return;
+	}
+
+	glBeginQuery(GL_TIME_ELAPSED, gpuQueries[gpuNext]);
+	gpuRunning = true;
+}
+
+void Profiler::EndGpuTimer() {
+	if (!gpuRunning) {
+		return;
+	}
+
+	glEndQuery(GL_TIME_ELAPSED);
+	gpuPending[gpuNext] = true;
+	gpuNext = (gpuNext + 1) % GPU_QUERIES;
+	gpuRunning = false;
+}
+
+void Profiler::Add(Metric metric, double amount) {
+	current[(int)metric] += amount;
+}
+
+void Profiler::SetExportInterval(double seconds) {
+	exportInterval = seconds;
+}
+
+void Profiler::DrawGui() {
+	ImGui::Begin("Profiler");
+
+	for (int i = 0; i < METRIC_COUNT; i++) {
+		char overlay[64];
+		snprintf(overlay, sizeof(overlay), IS_TIME[i] ? "%s: %.3f ms" : "%s: %.0f", NAMES[i], latest[i]);
+
+		// scale to the biggest value in the window, so small spikes are still visible
+		float peak = *std::max_element(history[i], history[i] + HISTORY);
+		ImGui::PushID(i);
+		ImGui::PlotHistogram("", history[i], HISTORY, historyCursor, overlay, 0.0f, std::max(peak, 0.001f), ImVec2(0, 40));
+		ImGui::PopID();
+	}
+
+	if (!AllocCounter::IsEnabled()) {
+		ImGui::TextDisabled("Allocations are only counted in Debug builds");
+	}
+
+	ImGui::End();
+}
+
+const char* Profiler::GetName(Metric metric) {
+	return NAMES[(int)metric];
+}
+
+double Profiler::GetLatest(Metric metric) {
+	return latest[(int)metric];
+}
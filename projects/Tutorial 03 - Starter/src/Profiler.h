@@ -0,0 +1,60 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+// Collects per-frame timings and counters, keeps a rolling history of them for the debug overlay, and logs a summary
+// every so often. Everything here is meant to be called from the main (GL) thread only
+class Profiler {
+public:
+	// Everything we measure. Timings are in milliseconds, the rest are counts per frame
+	enum class Metric {
+		Frame, // CPU time for the whole frame, not counting any sleep from the frame cap
+		Update, // Game::Update, including the sim ticks
+		SimStep, // SnakeSim::step, which is the movement and collision checks
+		Draw, // Game::Draw, building the batch and issuing the draw
+		Upload, // copying instance data into GL buffers
+		Gui, // building and drawing the ImGui overlay
+		GpuDraw, // GPU time for the draw pass, from a GL_TIME_ELAPSED query (arrives a few frames late)
+		DrawCalls, // draw calls we issued (not counting ImGui's)
+		GlObjects, // GL objects (buffers, vertex arrays, shaders, programs) created
+		Allocations, // heap allocations, only counted in builds with TRACK_ALLOCATIONS
+		Count
+	};
+
+	// Number of frames kept for the histograms
+	static constexpr int HISTORY = 120;
+
+	// Adds the time between construction and destruction to a timing metric for the current frame. Nesting is fine, each
+	// metric just sums up every scope that was opened for it
+	class Scope {
+	public:
+		Scope(Metric metric) : myMetric(metric), myStart(std::chrono::steady_clock::now()) { }
+		~Scope();
+
+	private:
+		Metric myMetric;
+		std::chrono::steady_clock::time_point myStart;
+	};
+
+	static void InitGpu(); // create the GL timer queries, needs a current GL context
+	static void ShutdownGpu(); // delete the GL timer queries
+
+	static void BeginFrame();
+	static void EndFrame(); // push this frame's values into the history, and log a summary if the export interval has passed
+
+	static void BeginGpuTimer(); // start timing GPU work, only one GPU timer can be running at a time
+	static void EndGpuTimer();
+
+	static void Add(Metric metric, double amount = 1.0); // add to a metric for the current frame (e.g. a draw call)
+	static void CountDrawCall() { Add(Metric::DrawCalls); }
+	static void CountGlObjects(int count = 1) { Add(Metric::GlObjects, count); }
+
+	// how often a summary of the last interval's averages and peaks is logged, 0 to turn logging off. 5 seconds by default
+	static void SetExportInterval(double seconds);
+
+	static void DrawGui(); // the profiler window with a rolling histogram for every metric
+
+	static const char* GetName(Metric metric);
+	static double GetLatest(Metric metric); // value from the last finished frame
+};
@@ -0,0 +1,10 @@
+#pragma once
+
+#include <GLM/glm.hpp> // For vec2 and vec4
+
+// A single quad to be drawn by the QuadRenderer, this is exactly what gets uploaded to the per-instance buffer
+struct QuadInstance {
+	glm::vec2 Position; // center of the quad in screen space
+	glm::vec2 Size; // full width and height of the quad
+	glm::vec4 Color;
+};
@@ -0,0 +1,104 @@
+#include "QuadRenderer.h"
+#include "Profiler.h"
+#include "Trace.h"
+#include <cstddef> // Needed for offsetof
+
+// The vertex buffer binding slot that our instance buffer is attached to, 0 and 1 are taken by the mesh attributes
+#define INSTANCE_BINDING 2
+
+QuadRenderer::QuadRenderer(size_t initialCapacity) {
+	// Our unit quad, centered on the origin. The color is white so that the instance color is used as-is
+	Vertex verts[4] = {
+		{ glm::vec3(-0.5f,  0.5f, 0.0f), glm::vec4(1.0f) }, // tl
+		{ glm::vec3( 0.5f,  0.5f, 0.0f), glm::vec4(1.0f) }, // tr
+		{ glm::vec3(-0.5f, -0.5f, 0.0f), glm::vec4(1.0f) }, // bl
+		{ glm::vec3( 0.5f, -0.5f, 0.0f), glm::vec4(1.0f) }  // br
+	};
+
+	// Create our 6 indices
+	uint32_t indices[6] = {
+		0, 1, 2,
+		2, 1, 3
+	};
+
+	myQuad = std::make_shared<Mesh>(verts, 4, indices, 6);
+
+	// Create our instance buffer and give it some initial storage
+	glCreateBuffers(1, &myInstanceBuffer);
+	Profiler::CountGlObjects();
+	myCapacity = 0;
+	__ReserveGpu(initialCapacity > 0 ? initialCapacity : 1);
+	myInstances.reserve(myCapacity);
+
+	GLuint vao = myQuad->GetVao();
+
+	// Attach the instance buffer to the quad's VAO, advancing one record per instance instead of per vertex
+	glVertexArrayVertexBuffer(vao, INSTANCE_BINDING, myInstanceBuffer, 0, sizeof(QuadInstance));
+	glVertexArrayBindingDivisor(vao, INSTANCE_BINDING, 1);
+
+	// Attribute 2 is the instance position (2 floats)
+	glEnableVertexArrayAttrib(vao, 2);
+	glVertexArrayAttribFormat(vao, 2, 2, GL_FLOAT, false, offsetof(QuadInstance, Position));
+	glVertexArrayAttribBinding(vao, 2, INSTANCE_BINDING);
+
+	// Attribute 3 is the instance size (2 floats)
+	glEnableVertexArrayAttrib(vao, 3);
+	glVertexArrayAttribFormat(vao, 3, 2, GL_FLOAT, false, offsetof(QuadInstance, Size));
+	glVertexArrayAttribBinding(vao, 3, INSTANCE_BINDING);
+
+	// Attribute 4 is the instance color (4 floats)
+	glEnableVertexArrayAttrib(vao, 4);
+	glVertexArrayAttribFormat(vao, 4, 4, GL_FLOAT, false, offsetof(QuadInstance, Color));
+	glVertexArrayAttribBinding(vao, 4, INSTANCE_BINDING);
+}
+
+QuadRenderer::~QuadRenderer() {
+	// Clean up our instance buffer, the quad mesh cleans up after itself
+	glDeleteBuffers(1, &myInstanceBuffer);
+}
+
+void QuadRenderer::Begin() {
+	// Keeps the allocation around, so steady state frames never touch the heap
+	myInstances.clear();
+}
+
+QuadInstance& QuadRenderer::Push() {
+	myInstances.emplace_back();
+	return myInstances.back();
+}
+
+void QuadRenderer::Submit(const QuadInstance& instance) {
+	myInstances.push_back(instance);
+}
+
+void QuadRenderer::Flush() {
+	if (myInstances.empty()) {
+		return;
+	}
+
+	{
+		TRACE_SCOPE("Upload instances");
+		Profiler::Scope upload(Profiler::Metric::Upload);
+
+		// Make sure the GPU buffer can hold everything we are about to upload
+		if (myInstances.size() > myCapacity) {
+			__ReserveGpu(myInstances.capacity());
+		}
+		else {
+			// Orphan the old storage so we don't have to wait on the GPU to finish drawing last frame's instances
+			glNamedBufferData(myInstanceBuffer, myCapacity * sizeof(QuadInstance), nullptr, GL_STREAM_DRAW);
+		}
+
+		// Upload this frame's instances
+		glNamedBufferSubData(myInstanceBuffer, 0, myInstances.size() * sizeof(QuadInstance), myInstances.data());
+	}
+
+	// And draw them all at once
+	myQuad->DrawInstanced(myInstances.size());
+}
+
+void QuadRenderer::__ReserveGpu(size_t capacity) {
+	// The buffer name stays the same, so the VAO binding remains valid after a resize
+	myCapacity = capacity;
+	glNamedBufferData(myInstanceBuffer, myCapacity * sizeof(QuadInstance), nullptr, GL_STREAM_DRAW);
+}
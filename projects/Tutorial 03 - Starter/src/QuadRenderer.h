@@ -0,0 +1,49 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <vector>
+#include <memory>
+
+#include "Mesh.h"
+#include "QuadInstance.h"
+
+// Draws every quad submitted during a frame with a single instanced draw call. All quads share one unit quad mesh,
+// and only their instance records (position, size and color) change from frame to frame
+class QuadRenderer {
+public:
+	typedef std::shared_ptr<QuadRenderer> Sptr;
+
+	// Creates the shared quad mesh, and an instance buffer with room for initialCapacity quads (it grows as needed)
+	QuadRenderer(size_t initialCapacity = 256);
+	~QuadRenderer();
+
+	// Clears all the instances that were submitted last frame
+	void Begin();
+
+	// Appends a new instance record to the batch and returns it so the caller can fill it in
+	QuadInstance& Push();
+	// Appends a copy of the given instance to the batch
+	void Submit(const QuadInstance& instance);
+
+	// Uploads all of this frame's instances and draws them, the instanced shader should already be bound
+	void Flush();
+
+	// Gets the number of quads that are currently in the batch
+	size_t GetInstanceCount() const { return myInstances.size(); }
+
+private:
+	// Reallocates the instance buffer so that it can hold at least capacity quads
+	void __ReserveGpu(size_t capacity);
+
+	// The unit quad that every instance is drawn with
+	Mesh_sptr myQuad;
+	// The GL handle for our per-instance buffer
+	GLuint myInstanceBuffer;
+	// The number of quads the instance buffer can currently hold
+	size_t myCapacity;
+	// CPU side copy of this frame's instances
+	std::vector<QuadInstance> myInstances;
+};
+
+// Shorthand for shared_ptr
+typedef std::shared_ptr<QuadRenderer> QuadRenderer_sptr;
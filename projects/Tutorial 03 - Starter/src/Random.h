@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+
+// A small, fast PCG32 random number generator (see pcg-random.org). The entire state is a single 64 bit integer, so
+// it is cheap to give every game its own generator, and the static versions can work on arrays of raw states
+class Random {
+public:
+	Random(uint64_t seed = 0) : state(Seed(seed)) { }
+
+	uint32_t next() { return Next(state); } // a uniformly random 32 bit number
+	uint32_t below(uint32_t bound) { return Below(state, bound); } // a random number in [0, bound)
+
+	// turns a seed into a starting state. The seed is scrambled first (splitmix64), so that seeds 1, 2, 3... don't
+	// start out as similar streams
+	static uint64_t Seed(uint64_t seed) {
+		uint64_t z = seed + 0x9E3779B97F4A7C15ull;
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+		return z ^ (z >> 31);
+	}
+
+	// advances a raw state and returns a uniformly random 32 bit number
+	static uint32_t Next(uint64_t& state) {
+		uint64_t old = state;
+		state = old * 6364136223846793005ull + 1442695040888963407ull;
+		uint32_t xorshifted = (uint32_t)(((old >> 18) ^ old) >> 27);
+		uint32_t rot = (uint32_t)(old >> 59);
+		return (xorshifted >> rot) | (xorshifted << ((0u - rot) & 31));
+	}
+
+	// advances a raw state and returns a random number in [0, bound). This scales rather than using a slow modulo, and
+	// rejects the few values that would make some results more likely than others (Lemire's method), so spawns are
+	// exactly uniform. The rejection almost never happens, and never for a power of two bound
+	static uint32_t Below(uint64_t& state, uint32_t bound) {
+		uint64_t scaled = (uint64_t)Next(state) * bound;
+		uint32_t low = (uint32_t)scaled;
+
+		if (low < bound) {
+			uint32_t threshold = (0u - bound) % bound;
+			while (low < threshold) {
+				scaled = (uint64_t)Next(state) * bound;
+				low = (uint32_t)scaled;
+			}
+		}
+
+		return (uint32_t)(scaled >> 32);
+	}
+
+	// creates a new generator for a child task (a sub-simulation, a bot's policy...) that won't share a stream with
+	// this one. Advances this generator
+	Random fork() {
+		uint64_t seed = ((uint64_t)next() << 32) | next();
+		return Random(seed);
+	}
+
+	uint64_t state;
+};
@@ -0,0 +1,178 @@
+#include "Replay.h"
+#include "SnakeSim.h"
+
+#include <fstream>
+#include <cereal/archives/binary.hpp>
+#include <cereal/types/vector.hpp>
+
+Replay::Cursor::Cursor(const Replay& replay) :
+	replay(&replay)
+{ }
+
+int Replay::Cursor::next()
+{
+	int input = -1;
+	if (event < replay->events.size() && replay->events[event].tick == tick) {
+		input = replay->events[event].direction;
+		event++;
+	}
+	tick++;
+	return input;
+}
+
+Replay::Replay(uint64_t seed, int width, int height) :
+	seed(seed),
+	width(width),
+	height(height)
+{
+	static_assert(DEFAULT_SIZE == SnakeSim::DEFAULT_SIZE, "Old replays have to load onto the sim's default board");
+
+	// a press every few ticks for a couple of minutes, so recording doesn't reallocate during normal play
+	events.reserve(1024);
+}
+
+void Replay::begin(uint64_t seed, int width, int height)
+{
+	this->seed = seed;
+	this->width = width;
+	this->height = height;
+	tickCount = 0;
+	checksum = 0;
+	events.clear();
+}
+
+void Replay::record(int input)
+{
+	if (input >= 0) {
+		events.push_back({ tickCount, (uint8_t)input });
+	}
+	tickCount++;
+}
+
+void Replay::truncate(uint64_t ticks)
+{
+	while (!events.empty() && events.back().tick >= ticks) {
+		events.pop_back();
+	}
+	if (ticks < tickCount) {
+		tickCount = ticks;
+	}
+	checksum = 0;
+}
+
+void Replay::resume(uint64_t ticks)
+{
+	events.clear();
+	tickCount = ticks;
+	checksum = 0;
+}
+
+void Replay::finish(const SnakeSim& sim)
+{
+	checksum = sim.getChecksum();
+}
+
+ReplayResult Replay::play(SnakeSim& sim) const
+{
+	ReplayResult result;
+	sim.reset(seed, width, height);
+
+	Cursor cursor(*this);
+	while (!cursor.done()) {
+		StepResult step = sim.step(cursor.next());
+
+		if (step.died || step.won) {
+			result.deaths += step.died;
+			result.wins += step.won;
+		}
+		else if (sim.getScore() > result.bestScore) {
+			result.bestScore = sim.getScore();
+		}
+	}
+
+	result.ticks = cursor.getTick();
+	result.finalScore = sim.getScore();
+	result.checksum = sim.getChecksum();
+	result.matches = checksum == 0 || checksum == result.checksum;
+	return result;
+}
+
+void Replay::writeFile(const std::string& path) const
+{
+	std::ofstream file(path, std::ios::binary);
+	if (!file) {
+		throw std::runtime_error("Failed to open replay for writing: " + path);
+	}
+
+	cereal::BinaryOutputArchive archive(file);
+	archive(*this);
+}
+
+Replay Replay::readFile(const std::string& path)
+{
+	std::ifstream file(path, std::ios::binary);
+	if (!file) {
+		throw std::runtime_error("Failed to open replay: " + path);
+	}
+
+	Replay result;
+	try {
+		cereal::BinaryInputArchive archive(file);
+		archive(result);
+	}
+	catch (const cereal::Exception& e) {
+		throw std::runtime_error("Replay is truncated or corrupt: " + path + " (" + e.what() + ")");
+	}
+	return result;
+}
+
+void Replay::__Encode(std::vector<uint8_t>& out) const
+{
+	out.clear();
+	out.reserve(events.size() * 2);
+
+	uint64_t prevTick = 0;
+	for (const Event& e : events) {
+		// the gap is almost always under 32 ticks, so most presses fit in a single byte
+		uint64_t value = ((e.tick - prevTick) << 2) | e.direction;
+		prevTick = e.tick;
+
+		while (value >= 0x80) {
+			out.push_back((uint8_t)(value | 0x80));
+			value >>= 7;
+		}
+		out.push_back((uint8_t)value);
+	}
+}
+
+void Replay::__Decode(const std::vector<uint8_t>& in)
+{
+	events.clear();
+
+	uint64_t tick = 0;
+	size_t i = 0;
+	while (i < in.size()) {
+		uint64_t value = 0;
+		int shift = 0;
+		uint8_t byte;
+		do {
+			if (i >= in.size() || shift > 63) {
+				throw std::runtime_error("Replay input stream is corrupt");
+			}
+			byte = in[i++];
+			value |= (uint64_t)(byte & 0x7F) << shift;
+			shift += 7;
+		} while (byte & 0x80);
+
+		// only the first press can be on the same tick as the previous one (tick 0)
+		uint64_t gap = value >> 2;
+		if (gap == 0 && !events.empty()) {
+			throw std::runtime_error("Replay has two inputs on the same tick");
+		}
+		tick += gap;
+		if (tick >= tickCount) {
+			throw std::runtime_error("Replay has input past its last tick");
+		}
+		events.push_back({ tick, (uint8_t)(value & 3) });
+	}
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+class SnakeSim;
+
+// What happened when a replay was played back headless
+struct ReplayResult {
+	uint64_t ticks = 0; // ticks that were simulated
+	int deaths = 0; // times the snake died during the replay
+	int wins = 0; // times the snake filled the board
+	int bestScore = 0; // highest score reached before a reset
+	int finalScore = 0; // score when the replay ended
+	uint64_t checksum = 0; // state of the sim when the replay ended
+	bool matches = true; // false if the sim ended up somewhere other than where the recording did (a desync)
+};
+
+// A whole session stored as the seed plus the input that was handed to the sim on every tick. The sim is deterministic,
+// so that is all that is needed to play a game back exactly. Most ticks have no input at all, so in memory only the
+// ticks where a key was pressed are kept, and on disk each of those is packed into a varint together with the number
+// of ticks since the previous one. A few minutes of play is usually well under a kilobyte
+class Replay {
+public:
+	// Hands back the recorded input one tick at a time
+	class Cursor {
+	public:
+		Cursor(const Replay& replay);
+
+		int next(); // the input for the next tick, or -1 if nothing was pressed (or the replay has ended)
+		bool done() const { return tick >= replay->getTickCount(); } // true once every recorded tick has been handed out
+		uint64_t getTick() const { return tick; } // ticks handed out so far
+
+	private:
+		const Replay* replay;
+		size_t event = 0; // next key press to hand out
+		uint64_t tick = 0;
+	};
+
+	Replay(uint64_t seed = 0, int width = DEFAULT_SIZE, int height = DEFAULT_SIZE);
+
+	// throw away everything that was recorded and start over from a new seed, on a board of the given size
+	void begin(uint64_t seed, int width = DEFAULT_SIZE, int height = DEFAULT_SIZE);
+	void record(int input); // add the input for the next tick, -1 for no input
+	void truncate(uint64_t ticks); // forget every tick from the given one on, for when the game is rewound
+	void resume(uint64_t ticks); // forget every input, and carry on counting from the given tick, for a game picked up from a save
+	void finish(const SnakeSim& sim); // remember where the sim ended up, so playback can check that it gets there too
+
+	uint64_t getSeed() const { return seed; }
+	int getWidth() const { return width; } // board size the game was played on
+	int getHeight() const { return height; }
+	uint64_t getTickCount() const { return tickCount; } // number of ticks that have been recorded
+	size_t getInputCount() const { return events.size(); } // number of ticks that had an input
+	uint64_t getChecksum() const { return checksum; } // SnakeSim::getChecksum() at the end of the recording, 0 if unknown
+
+	// step the sim through every recorded tick as fast as it will go, starting from the replay's seed and board size
+	ReplayResult play(SnakeSim& sim) const;
+
+	void writeFile(const std::string& path) const; // throws if the file can't be written
+	static Replay readFile(const std::string& path); // throws if the file can't be read or isn't a replay
+
+	// cereal hooks, the inputs are varint encoded on save and decoded on load
+	template<class Archive> void save(Archive& archive) const {
+		std::vector<uint8_t> packed;
+		__Encode(packed);
+		archive(MAGIC, VERSION, seed, width, height, tickCount, checksum, packed);
+	}
+	template<class Archive> void load(Archive& archive) {
+		uint32_t magic, version;
+		std::vector<uint8_t> packed;
+		archive(magic, version);
+		if (magic != MAGIC || version < 1 || version > VERSION) {
+			throw std::runtime_error("Not a replay, or a replay from a different version of the game");
+		}
+
+		// replays from before the board size could be changed were all played on the default board
+		archive(seed);
+		width = height = DEFAULT_SIZE;
+		if (version >= 2) {
+			archive(width, height);
+		}
+		archive(tickCount, checksum, packed);
+		__Decode(packed);
+	}
+
+private:
+	static constexpr uint32_t MAGIC = 0x524B4E53; // "SNKR"
+	static constexpr uint32_t VERSION = 2; // 2 added the board size
+	static constexpr int DEFAULT_SIZE = 39; // SnakeSim::DEFAULT_SIZE, the sim isn't included here
+
+	// A tick where a key was pressed
+	struct Event {
+		uint64_t tick;
+		uint8_t direction; // 0 up, 1 down, 2 left, 3 right
+	};
+
+	void __Encode(std::vector<uint8_t>& out) const; // each event becomes varint((ticks since last event << 2) | direction)
+	void __Decode(const std::vector<uint8_t>& in); // throws if the data runs past the recorded tick count
+
+	uint64_t seed;
+	int width, height;
+	uint64_t tickCount = 0;
+	uint64_t checksum = 0;
+	std::vector<Event> events; // in tick order
+};
+
+// Shorthand for shared_ptr
+typedef std::shared_ptr<Replay> Replay_sptr;
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// A double ended queue stored in one contiguous power of two sized array. Items are pushed on at the front and
+// retired from the back in constant time without touching anything in between, which is exactly how a snake moves
+template <typename T>
+class RingBuffer {
+public:
+	RingBuffer(size_t initialCapacity = 64) {
+		// round up to a power of two, so that wrapping an index is just a mask
+		size_t capacity = 1;
+		while (capacity < initialCapacity) {
+			capacity <<= 1;
+		}
+		items.resize(capacity);
+	}
+
+	// adds an item in front of the current front, growing the storage if we are full
+	void pushFront(const T& item) {
+		if (count == items.size()) {
+			grow();
+		}
+		first = (first - 1) & mask();
+		items[first] = item;
+		count++;
+	}
+
+	// removes the item at the back
+	void popBack() {
+		count--;
+	}
+
+	// removes every item, the storage is kept around for reuse
+	void clear() {
+		first = 0;
+		count = 0;
+	}
+
+	// gets the i'th item, counting from the front
+	T& operator[](size_t i) { return items[(first + i) & mask()]; }
+	const T& operator[](size_t i) const { return items[(first + i) & mask()]; }
+
+	T& front() { return items[first]; }
+	const T& front() const { return items[first]; }
+	T& back() { return (*this)[count - 1]; }
+	const T& back() const { return (*this)[count - 1]; }
+
+	size_t size() const { return count; }
+	bool empty() const { return count == 0; }
+	size_t capacity() const { return items.size(); }
+
+private:
+	size_t mask() const { return items.size() - 1; }
+
+	// doubles the storage, and unrolls the items so the front is back at index 0
+	void grow() {
+		std::vector<T> bigger(items.size() * 2);
+		for (size_t i = 0; i < count; i++) {
+			bigger[i] = (*this)[i];
+		}
+		items.swap(bigger);
+		first = 0;
+	}
+
+	std::vector<T> items; // storage, always a power of two in size
+	size_t first = 0; // index of the front item in storage
+	size_t count = 0; // number of items currently in the buffer
+};
@@ -1,7 +1,72 @@
 #include "Shader.h"
 #include "Logging.h"
+#include "Profiler.h"
+#include "ShaderCache.h"
 #include <stdexcept>
+#include <filesystem>
 #include <fstream>
+#include <cstring>
+
+// From GL_KHR_parallel_shader_compile (and the ARB version of it), which glad was generated without. Drivers that have
+// it already compile on as many threads as they like by default, so polling this is all that is needed
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+namespace {
+	// The game loads the copies of its resources that the build puts next to the executable, and those get overwritten
+	// by the next build. RES_DIR is the project's res directory (premake defines it), so that is where edits are made
+	std::string sourcePath(const std::string& file) {
+#ifdef RES_DIR
+		std::filesystem::path source = std::filesystem::path(RES_DIR) / file;
+		if (std::filesystem::exists(source)) {
+			return source.string();
+		}
+#endif
+		return file;
+	}
+
+	// Whether the driver can tell us a program has finished linking without waiting for it
+	bool hasParallelCompile() {
+		static int supported = -1;
+		if (supported < 0) {
+			supported = 0;
+			GLint count = 0;
+			glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+			for (GLint i = 0; i < count; i++) {
+				const char* name = (const char*)glGetStringi(GL_EXTENSIONS, i);
+				if (strcmp(name, "GL_KHR_parallel_shader_compile") == 0 || strcmp(name, "GL_ARB_parallel_shader_compile") == 0) {
+					supported = 1;
+				}
+			}
+		}
+		return supported == 1;
+	}
+
+	// Logs why a shader part or program didn't build, from its info log
+	void logInfo(GLuint object, bool isProgram, const char* what) {
+		GLint length = 0;
+		if (isProgram) {
+			glGetProgramiv(object, GL_INFO_LOG_LENGTH, &length);
+		}
+		else {
+			glGetShaderiv(object, GL_INFO_LOG_LENGTH, &length);
+		}
+		if (length <= 0) {
+			return;
+		}
+
+		std::string log(length, '\0');
+		if (isProgram) {
+			glGetProgramInfoLog(object, length, &length, &log[0]);
+		}
+		else {
+			glGetShaderInfoLog(object, length, &length, &log[0]);
+		}
+		log.resize(length);
+		LOG_ERROR("{}:\n{}", what, log);
+	}
+}
 
 // Reads the entire contents of a file
 char* readFile(const char* filename) {
@@ -42,13 +107,21 @@ char* readFile(const char* filename) {
 
 Shader::Shader() {
 	myShaderHandle = glCreateProgram();
+	Profiler::CountGlObjects();
 }
 
 Shader::~Shader() {
+	__DiscardReload();
 	glDeleteProgram(myShaderHandle);
 }
 
 void Shader::Compile(const char* vs_source, const char* fs_source) {
+	// If these sources have been linked before on this driver, the cache can hand us the finished program
+	if (ShaderCache::Load(myShaderHandle, vs_source, fs_source)) {
+		LOG_TRACE("Shader has been loaded from the cache");
+		return;
+	}
+
 	// Compile our two shader programs
 	GLuint vs = __CompileShaderPart(vs_source, GL_VERTEX_SHADER);
 	GLuint fs = __CompileShaderPart(fs_source, GL_FRAGMENT_SHADER);
@@ -95,6 +168,7 @@ void Shader::Compile(const char* vs_source, const char* fs_source) {
 	}
 	else {
 		LOG_TRACE("Shader has been linked");
+		ShaderCache::Store(myShaderHandle, vs_source, fs_source);
 	}
 }
 
@@ -110,6 +184,143 @@ void Shader::Load(const char* vsFile, const char* fsFile)
 	// Clean up our memory
 	delete[] fs_source;
 	delete[] vs_source;
+
+	// Remember where we came from, for hot reloading
+	myVsFile = vsFile;
+	myFsFile = fsFile;
+}
+
+void Shader::SetHotReload(bool enabled) {
+	if (!enabled) {
+		myWatcher = nullptr;
+		__DiscardReload();
+		return;
+	}
+	if (myWatcher != nullptr || myVsFile.empty()) {
+		return;
+	}
+
+	// reloads read from the same files that are watched
+	myVsFile = sourcePath(myVsFile);
+	myFsFile = sourcePath(myFsFile);
+
+	myWatcher = std::make_shared<FileWatcher>();
+	myWatcher->Add(myVsFile);
+	myWatcher->Add(myFsFile);
+	LOG_INFO("Watching {} and {} for changes", myVsFile, myFsFile);
+}
+
+void Shader::Update() {
+	if (myWatcher == nullptr) {
+		return;
+	}
+
+	// a save while the last one is still compiling just starts over with the newest sources
+	if (myWatcher->Poll()) {
+		__BeginReload();
+	}
+
+	if (myPendingHandle != 0) {
+		// without the extension there is no way to ask, and the link status query below waits for the driver
+		GLint done = GL_TRUE;
+		if (hasParallelCompile()) {
+			glGetProgramiv(myPendingHandle, GL_COMPLETION_STATUS_KHR, &done);
+		}
+		if (done == GL_TRUE) {
+			__FinishReload();
+		}
+	}
+}
+
+void Shader::__BeginReload() {
+	__DiscardReload();
+
+	char* vs_source;
+	char* fs_source;
+	try {
+		vs_source = readFile(myVsFile.c_str());
+	}
+	catch (const std::exception&) {
+		LOG_WARN("Couldn't read {}, keeping the old shader", myVsFile);
+		return;
+	}
+	try {
+		fs_source = readFile(myFsFile.c_str());
+	}
+	catch (const std::exception&) {
+		LOG_WARN("Couldn't read {}, keeping the old shader", myFsFile);
+		delete[] vs_source;
+		return;
+	}
+	myPendingVs = vs_source;
+	myPendingFs = fs_source;
+	delete[] fs_source;
+	delete[] vs_source;
+
+	// none of these wait on the compiler, nothing is asked about the result until it says it's done
+	myPendingHandle = glCreateProgram();
+	Profiler::CountGlObjects();
+	glProgramParameteri(myPendingHandle, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+
+	const char* sources[2] = { myPendingVs.c_str(), myPendingFs.c_str() };
+	const GLenum types[2] = { GL_VERTEX_SHADER, GL_FRAGMENT_SHADER };
+	for (int i = 0; i < 2; i++) {
+		myPendingParts[i] = glCreateShader(types[i]);
+		Profiler::CountGlObjects();
+		glShaderSource(myPendingParts[i], 1, &sources[i], NULL);
+		glCompileShader(myPendingParts[i]);
+		glAttachShader(myPendingHandle, myPendingParts[i]);
+	}
+	glLinkProgram(myPendingHandle);
+
+	LOG_INFO("Recompiling {} and {}", myVsFile, myFsFile);
+}
+
+void Shader::__FinishReload() {
+	GLint success = GL_FALSE;
+	glGetProgramiv(myPendingHandle, GL_LINK_STATUS, &success);
+
+	if (success == GL_FALSE) {
+		// a compile error is far more likely than a link error, and is only in the part's own log
+		const char* names[2] = { "Vertex shader failed to compile", "Fragment shader failed to compile" };
+		for (int i = 0; i < 2; i++) {
+			GLint compiled = GL_FALSE;
+			glGetShaderiv(myPendingParts[i], GL_COMPILE_STATUS, &compiled);
+			if (compiled == GL_FALSE) {
+				logInfo(myPendingParts[i], false, names[i]);
+			}
+		}
+		logInfo(myPendingHandle, true, "Shader failed to link");
+		LOG_WARN("Keeping the old shader until {} and {} build", myVsFile, myFsFile);
+		__DiscardReload();
+		return;
+	}
+
+	// swap the new program in, anything bound from here on uses it
+	glDeleteProgram(myShaderHandle);
+	myShaderHandle = myPendingHandle;
+	myPendingHandle = 0;
+	for (GLuint& part : myPendingParts) {
+		glDetachShader(myShaderHandle, part);
+		glDeleteShader(part);
+		part = 0;
+	}
+	ShaderCache::Store(myShaderHandle, myPendingVs.c_str(), myPendingFs.c_str());
+
+	LOG_INFO("Reloaded {} and {}", myVsFile, myFsFile);
+}
+
+void Shader::__DiscardReload() {
+	for (GLuint& part : myPendingParts) {
+		if (part != 0) {
+			glDeleteShader(part);
+			part = 0;
+		}
+	}
+	if (myPendingHandle != 0) {
+		glDeleteProgram(myPendingHandle);
+		myPendingHandle = 0;
+	}
 }
 
 void Shader::Bind() {
@@ -118,6 +329,7 @@ void Shader::Bind() {
 
 GLuint Shader::__CompileShaderPart(const char* source, GLenum type) {
 	GLuint result = glCreateShader(type);
+	Profiler::CountGlObjects();
 
 	// Load in our shader source and compile it
 	glShaderSource(result, 1, &source, NULL);
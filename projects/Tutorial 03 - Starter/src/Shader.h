@@ -2,6 +2,9 @@
 
 #include <glad/glad.h>
 #include <memory>
+#include <string>
+
+#include "FileWatcher.h"
 
 class Shader {
 public:
@@ -14,13 +17,34 @@ public:
 	// the path to the fragment shader
 	void Load(const char* vsFile, const char* fsFile);
 
+	// Watch the files from Load, and rebuild the program whenever one of them is saved. Files that are in the project's
+	// res directory are watched there rather than as the copies next to the executable. The new program is compiled
+	// in the background (on the driver's own threads when it has GL_KHR_parallel_shader_compile), and the old one
+	// stays in use until it has linked, so an edit never stalls a frame and a broken edit just logs its errors
+	void SetHotReload(bool enabled);
+	// Checks for edits and swaps over to a program that has finished compiling, call once a frame
+	void Update();
+
 	void Bind();
 
 private:
 	GLuint __CompileShaderPart(const char* source, GLenum type);
 
+	void __BeginReload(); // reads the files again and starts compiling them into myPendingHandle
+	void __FinishReload(); // swaps myPendingHandle in if it linked, or logs why it didn't and throws it away
+	void __DiscardReload();
+
 	GLuint myShaderHandle;
+
+	// The files the program was loaded from, empty if it came from Compile
+	std::string myVsFile, myFsFile;
+	FileWatcher_sptr myWatcher;
+
+	// The program being rebuilt after an edit, 0 when there isn't one, along with its parts and sources
+	GLuint myPendingHandle = 0;
+	GLuint myPendingParts[2] = { 0, 0 };
+	std::string myPendingVs, myPendingFs;
 };
 
 
-typedef std::shared_ptr<Shader> Shader_sptr;
\ No newline at end of file
+typedef std::shared_ptr<Shader> Shader_sptr;
@@ -0,0 +1,177 @@
+#include "SimRunner.h"
+#include "Trace.h"
+
+#include <chrono>
+
+SimRunner::SimRunner(uint32_t threadCount, int width, int height) :
+	width(width),
+	height(height),
+	jobTicks(0)
+{
+	SnakeSim::checkSize(width, height);
+
+	if (threadCount == 0) {
+		threadCount = std::thread::hardware_concurrency();
+	}
+	if (threadCount == 0) {
+		threadCount = 1;
+	}
+
+	for (uint32_t i = 0; i < threadCount; i++) {
+		queues.push_back(std::make_unique<WorkQueue>());
+	}
+	for (uint32_t i = 0; i < threadCount; i++) {
+		workers.emplace_back(&SimRunner::workerLoop, this, i);
+	}
+}
+
+SimRunner::~SimRunner() {
+	{
+		std::lock_guard<std::mutex> lock(stateMutex);
+		shuttingDown = true;
+	}
+	startCondition.notify_all();
+
+	for (std::thread& worker : workers) {
+		worker.join();
+	}
+}
+
+RunStats SimRunner::run(const std::vector<uint64_t>& seeds, uint64_t maxTicks, Policy policy) {
+	RunStats stats;
+	stats.episodes.resize(seeds.size());
+
+	// deal the episodes out in contiguous blocks, stealing evens things out from there
+	uint32_t workerCount = (uint32_t)workers.size();
+	for (uint32_t i = 0; i < seeds.size(); i++) {
+		queues[(uint64_t)i * workerCount / seeds.size()]->tasks.push_back(i);
+	}
+
+	auto start = std::chrono::steady_clock::now();
+
+	{
+		std::unique_lock<std::mutex> lock(stateMutex);
+		jobSeeds = &seeds;
+		jobResults = &stats.episodes;
+		jobMaxTicks = maxTicks;
+		jobPolicy = policy ? policy : Policy(RandomPolicy);
+		jobTicks = 0;
+		busyWorkers = workerCount;
+		generation++;
+		startCondition.notify_all();
+
+		// wait for every worker to run out of things to steal
+		doneCondition.wait(lock, [this]() { return busyWorkers == 0; });
+
+		jobSeeds = nullptr;
+		jobResults = nullptr;
+		jobPolicy = nullptr;
+	}
+
+	stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	stats.totalTicks = jobTicks;
+	stats.ticksPerSecond = stats.seconds > 0.0 ? stats.totalTicks / stats.seconds : 0.0;
+	return stats;
+}
+
+int SimRunner::RandomPolicy(const SnakeSim& /*sim*/, Random& rng) {
+	// -1 keeps going straight, 0-3 turn
+	return (int)rng.below(5) - 1;
+}
+
+void SimRunner::workerLoop(uint32_t worker) {
+	TRACE_THREAD_NAME("SimRunner worker");
+
+	// every worker reuses the same sim for all of its episodes, so running doesn't allocate once it has warmed up
+	SnakeSim sim(0, width, height);
+	uint64_t seenGeneration = 0;
+
+	while (true) {
+		{
+			std::unique_lock<std::mutex> lock(stateMutex);
+			startCondition.wait(lock, [&]() { return shuttingDown || generation != seenGeneration; });
+			if (shuttingDown) {
+				return;
+			}
+			seenGeneration = generation;
+		}
+
+		// work through our own queue, then help everybody else with theirs
+		uint32_t task;
+		while (popTask(worker, task) || stealTask(worker, task)) {
+			playEpisode(sim, task);
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(stateMutex);
+			busyWorkers--;
+			if (busyWorkers == 0) {
+				doneCondition.notify_all();
+			}
+		}
+	}
+}
+
+bool SimRunner::popTask(uint32_t worker, uint32_t& task) {
+	WorkQueue& queue = *queues[worker];
+	std::lock_guard<std::mutex> lock(queue.mutex);
+
+	if (queue.tasks.empty()) {
+		return false;
+	}
+
+	task = queue.tasks.back();
+	queue.tasks.pop_back();
+	return true;
+}
+
+bool SimRunner::stealTask(uint32_t worker, uint32_t& task) {
+	// check everybody else once, starting with our neighbour
+	uint32_t workerCount = (uint32_t)queues.size();
+	for (uint32_t i = 1; i < workerCount; i++) {
+		WorkQueue& victim = *queues[(worker + i) % workerCount];
+		std::lock_guard<std::mutex> lock(victim.mutex);
+
+		if (!victim.tasks.empty()) {
+			task = victim.tasks.front();
+			victim.tasks.pop_front();
+			return true;
+		}
+	}
+
+	// since no new tasks are added during a run, if everyone is empty we are done
+	return false;
+}
+
+void SimRunner::playEpisode(SnakeSim& sim, uint32_t task) {
+	TRACE_SCOPE("Episode");
+
+	uint64_t seed = (*jobSeeds)[task];
+	EpisodeResult& result = (*jobResults)[task];
+
+	// the game and the policy each get a stream derived from the episode's seed, so nothing depends on which thread
+	// plays the episode or what it played before
+	sim.reset(seed);
+	Random policyRng(~seed);
+
+	result = EpisodeResult();
+	result.seed = seed;
+
+	while (result.ticks < jobMaxTicks) {
+		int score = sim.getScore();
+		StepResult step = sim.step(jobPolicy(sim, policyRng));
+		result.ticks++;
+
+		if (step.died || step.won) {
+			// the sim has already reset itself, so take the score from before the tick
+			result.score = score + step.scoreGained;
+			result.died = step.died;
+			result.won = step.won;
+			break;
+		}
+
+		result.score = sim.getScore();
+	}
+
+	jobTicks.fetch_add(result.ticks, std::memory_order_relaxed);
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "SnakeSim.h"
+#include "Random.h"
+
+// How a single episode played out
+struct EpisodeResult {
+	uint64_t seed = 0; // the seed the episode was played from
+	int score = 0; // points earned before the episode ended
+	uint64_t ticks = 0; // number of ticks the episode lasted
+	bool died = false; // the snake ran into itself or an obstacle
+	bool won = false; // the snake filled the board
+};
+
+// Totals for a whole run
+struct RunStats {
+	std::vector<EpisodeResult> episodes; // one result per seed, in the same order as the seeds
+	uint64_t totalTicks = 0; // ticks simulated across every episode
+	double seconds = 0.0; // wall clock time the run took
+	double ticksPerSecond = 0.0; // aggregate sim speed across every thread
+};
+
+// Plays many headless games of snake across a pool of worker threads. Every episode is queued up front, spread over one
+// queue per worker. Workers take from the back of their own queue and, once it runs dry, steal from the front of
+// somebody else's, so a worker that got a few very long games doesn't hold up the run while the others sit idle.
+// An episode only depends on its seed, so the results are identical no matter how many threads are used
+class SimRunner {
+public:
+	// Picks the input for the next tick, given the sim and a random stream that belongs to the episode
+	typedef std::function<int(const SnakeSim& sim, Random& rng)> Policy;
+
+	// starts threadCount workers, 0 uses one per hardware thread. Every episode is played on a width x height board,
+	// throws if that is out of range for SnakeSim
+	SimRunner(uint32_t threadCount = 0, int width = SnakeSim::DEFAULT_SIZE, int height = SnakeSim::DEFAULT_SIZE);
+	~SimRunner();
+
+	// plays one episode per seed, each until the snake dies, wins or hits maxTicks. A null policy plays randomly
+	RunStats run(const std::vector<uint64_t>& seeds, uint64_t maxTicks, Policy policy = nullptr);
+
+	uint32_t getThreadCount() const { return (uint32_t)workers.size(); }
+
+	// the default policy, picks a random direction (or keeps going straight) every tick
+	static int RandomPolicy(const SnakeSim& sim, Random& rng);
+
+private:
+	// A worker's queue of episode indices, the owner works from the back and thieves take from the front
+	struct WorkQueue {
+		std::mutex mutex;
+		std::deque<uint32_t> tasks;
+	};
+
+	void workerLoop(uint32_t worker); // waits for runs, and works on them until there is nothing left to steal
+	bool popTask(uint32_t worker, uint32_t& task); // takes the newest task from our own queue
+	bool stealTask(uint32_t worker, uint32_t& task); // takes the oldest task from another worker's queue
+	void playEpisode(SnakeSim& sim, uint32_t task); // plays a single episode and writes its result
+
+	int width, height; // board size of every episode
+	std::vector<std::thread> workers;
+	std::vector<std::unique_ptr<WorkQueue>> queues;
+
+	// the run that is currently being worked on
+	const std::vector<uint64_t>* jobSeeds = nullptr;
+	std::vector<EpisodeResult>* jobResults = nullptr;
+	uint64_t jobMaxTicks = 0;
+	Policy jobPolicy;
+	std::atomic<uint64_t> jobTicks;
+
+	// used to hand runs to the workers, and to find out when they have all finished
+	std::mutex stateMutex;
+	std::condition_variable startCondition;
+	std::condition_variable doneCondition;
+	uint64_t generation = 0; // bumped for every run, so workers know there is new work
+	uint32_t busyWorkers = 0; // workers that haven't finished the current run yet
+	bool shuttingDown = false;
+};
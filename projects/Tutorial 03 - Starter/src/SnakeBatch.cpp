@@ -0,0 +1,189 @@
+#include "SnakeBatch.h"
+#include "SnakeSim.h"
+#include "SnakeRules.h"
+#include "Random.h"
+
+#include <algorithm>
+
+SnakeBatch::SnakeBatch(uint32_t envCount, uint64_t seed, int width, int height) :
+	envCount(envCount),
+	width(width),
+	height(height),
+	headX(envCount), headY(envCount),
+	direction(envCount),
+	growth(envCount),
+	score(envCount),
+	whichFruit(envCount),
+	obTicks(envCount),
+	rngState(envCount),
+	nextX(envCount), nextY(envCount),
+	rewards(envCount),
+	dones(envCount)
+{
+	SnakeSim::checkSize(width, height);
+
+	// every body and board is sized for a full board up front (up to a few thousand cells, past that they grow with the
+	// snake), the same as SnakeSim, so on boards that fit stepping never allocates
+	boards.reserve(envCount);
+	bodies.reserve(envCount);
+
+	for (uint32_t env = 0; env < envCount; env++) {
+		size_t reserved = std::min((size_t)width * height, (size_t)4096);
+		boards.emplace_back(width, height);
+		boards.back().reserve((uint32_t)reserved);
+		bodies.emplace_back(reserved);
+
+		// give every game its own stream, so they play out independently
+		rngState[env] = Random::Seed(seed + env);
+	}
+
+	resetAll();
+}
+
+void SnakeBatch::stepAll(const int8_t* actions)
+{
+	// steer and move every head, and wrap it around the board. These only read and write flat arrays, so they
+	// vectorize. Everything is pulled into locals first so the compiler knows the stores can't change the loop bounds,
+	// and each loop only touches a few arrays to keep the runtime aliasing checks cheap
+	{
+		const uint32_t count = envCount;
+		const int32_t w = width, h = height;
+		const int32_t* hx = headX.data();
+		const int32_t* hy = headY.data();
+		int32_t* dirs = direction.data();
+		int32_t* nx = nextX.data();
+		int32_t* ny = nextY.data();
+
+		for (uint32_t env = 0; env < count; env++) {
+			dirs[env] = SnakeRules::steer(dirs[env], actions[env]);
+		}
+
+		for (uint32_t env = 0; env < count; env++) {
+			nx[env] = SnakeRules::wrap(hx[env] + SnakeRules::stepX(dirs[env]), w);
+		}
+
+		for (uint32_t env = 0; env < count; env++) {
+			ny[env] = SnakeRules::wrap(hy[env] + SnakeRules::stepY(dirs[env]), h);
+		}
+	}
+
+	// the tail moves out of its cell first, so the head is allowed to follow right behind it
+	for (uint32_t env = 0; env < envCount; env++) {
+		if (growth[env] > 0) {
+			growth[env]--;
+		}
+		else {
+			boards[env].set(bodies[env].back(), CellType::Empty);
+			bodies[env].popBack();
+		}
+	}
+
+	// resolve what every head ran into, this is the same single cell lookup that SnakeSim does
+	for (uint32_t env = 0; env < envCount; env++) {
+		Grid& board = boards[env];
+		glm::ivec2 head(nextX[env], nextY[env]);
+
+		rewards[env] = 0.0f;
+		dones[env] = 0;
+
+		switch (board.get(head)) {
+		case CellType::Snake: // die if collidiing with self
+		case CellType::Obstacle: // or with an obstacle
+			rewards[env] = SnakeRules::DEATH_REWARD;
+			dones[env] = 1;
+			reset(env);
+			continue;
+
+		case CellType::Fruit: // add length to snek and score, 1 for a fruit and 2 for a big fruit
+			growth[env] += whichFruit[env];
+			score[env] += whichFruit[env];
+			rewards[env] = (float)whichFruit[env];
+			break;
+
+		default:
+			break;
+		}
+
+		bodies[env].pushFront(head);
+		board.set(head, CellType::Snake);
+		headX[env] = head.x;
+		headY[env] = head.y;
+
+		if (rewards[env] > 0.0f) {
+			whichFruit[env] = (int32_t)Random::Below(rngState[env], 2) + 1; // set which fruit to spawn
+
+			// gen new fruit pos, if there is nowhere left to put it the snake has filled the board
+			glm::ivec2 fruit;
+			if (!randomEmptyCell(env, fruit)) {
+				dones[env] = 1;
+				reset(env);
+				continue;
+			}
+			board.set(fruit, CellType::Fruit);
+		}
+
+		obTicks[env]++;
+
+		if (obTicks[env] >= (int32_t)SnakeSim::OBSTACLE_TICKS) {
+			glm::ivec2 cell;
+			if (randomEmptyCell(env, cell)) {
+				board.set(cell, CellType::Obstacle);
+			}
+			obTicks[env] = 0;
+		}
+	}
+}
+
+void SnakeBatch::resetAll()
+{
+	for (uint32_t env = 0; env < envCount; env++) {
+		reset(env);
+	}
+}
+
+void SnakeBatch::reset(uint32_t env)
+{
+	// same starting layout as SnakeSim::resetGame
+	Grid& board = boards[env];
+	board.clear();
+
+	headX[env] = width / 2;
+	headY[env] = height / 2;
+	bodies[env].clear();
+	bodies[env].pushFront(glm::ivec2(headX[env], headY[env]));
+	board.set(bodies[env].front(), CellType::Snake);
+
+	direction[env] = 0;
+	growth[env] = 0;
+	score[env] = 0;
+	obTicks[env] = 0;
+
+	glm::ivec2 cell;
+	if (randomEmptyCell(env, cell)) {
+		board.set(cell, CellType::Obstacle);
+	}
+
+	whichFruit[env] = 1;
+	if (randomEmptyCell(env, cell)) {
+		board.set(cell, CellType::Fruit);
+	}
+}
+
+void SnakeBatch::writeObservations(uint8_t* out) const
+{
+	size_t size = getObservationSize();
+	for (uint32_t env = 0; env < envCount; env++) {
+		boards[env].copyCells((CellType*)(out + env * size));
+	}
+}
+
+bool SnakeBatch::randomEmptyCell(uint32_t env, glm::ivec2& cell)
+{
+	uint32_t emptyCount = boards[env].getEmptyCount();
+	if (emptyCount == 0) {
+		return false;
+	}
+
+	cell = boards[env].getEmptyCell(Random::Below(rngState[env], emptyCount));
+	return true;
+}
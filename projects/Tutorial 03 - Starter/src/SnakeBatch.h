@@ -0,0 +1,76 @@
+#pragma once
+
+#include <GLM/glm.hpp>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "Grid.h"
+#include "RingBuffer.h"
+#include "SnakeSim.h"
+
+// Steps many independent games of snake at once, for training and evaluating bots. The per game state that every
+// tick touches (heads, directions, lengths, random states...) is stored as one array per field, so the movement,
+// wrap-around and steering kernels run down contiguous arrays and can be vectorized. Each game still has its own board
+// and body, and plays by exactly the same rules as SnakeSim. A game that ends is reset straight away
+class SnakeBatch {
+public:
+	// creates envCount games on width x height boards. Each game gets its own random stream derived from seed. Throws
+	// if the board size is out of range for SnakeSim
+	SnakeBatch(uint32_t envCount, uint64_t seed, int width = SnakeSim::DEFAULT_SIZE, int height = SnakeSim::DEFAULT_SIZE);
+
+	// advances every game by one tick. actions holds one direction per game (0 up, 1 down, 2 left, 3 right), or -1 to
+	// keep going straight. After this, getRewards and getDones hold the results of the tick
+	void stepAll(const int8_t* actions);
+
+	void resetAll(); // starts every game over
+	void reset(uint32_t env); // starts a single game over
+
+	// copies every board into out as one byte per cell (the CellType values), one board after another. out must hold
+	// getEnvCount() * getObservationSize() bytes
+	void writeObservations(uint8_t* out) const;
+	size_t getObservationSize() const { return (size_t)width * height; } // number of cells in one board
+	int getWidth() const { return width; }
+	int getHeight() const { return height; }
+	const Grid& getBoard(uint32_t env) const { return boards[env]; } // the board of a single game, without copying
+
+	const float* getRewards() const { return rewards.data(); } // points earned last tick, or SnakeRules::DEATH_REWARD
+	const uint8_t* getDones() const { return dones.data(); } // 1 if the game ended last tick (it has been reset since)
+
+	const int32_t* getHeadX() const { return headX.data(); } // head cell of every game
+	const int32_t* getHeadY() const { return headY.data(); }
+	const int32_t* getDirections() const { return direction.data(); } // direction every head moved in last tick
+	const int32_t* getScores() const { return score.data(); } // points in the current episode of every game
+	uint32_t getLength(uint32_t env) const { return (uint32_t)bodies[env].size(); } // number of snek parts
+
+	uint32_t getEnvCount() const { return envCount; }
+
+private:
+	bool randomEmptyCell(uint32_t env, glm::ivec2& cell); // pick a random empty cell on a game's board
+
+	uint32_t envCount;
+	int32_t width, height;
+
+	// hot per game state, one entry per game
+	std::vector<int32_t> headX, headY; // head cell
+	std::vector<int32_t> direction; // direction of the head
+	std::vector<int32_t> growth; // ticks the tail still has to stay put for
+	std::vector<int32_t> score; // points this episode
+	std::vector<int32_t> whichFruit; // 1 reg fruit, 2 big fruit
+	std::vector<int32_t> obTicks; // ticks since the last obstacle was spawned
+	std::vector<uint64_t> rngState; // PCG32 state of every game
+
+	// scratch space for the next head cell of every game, filled in by the movement kernel
+	std::vector<int32_t> nextX, nextY;
+
+	// results of the last tick
+	std::vector<float> rewards;
+	std::vector<uint8_t> dones;
+
+	// cold per game state, only touched by the game it belongs to
+	std::vector<Grid> boards; // what is in each cell
+	std::vector<RingBuffer<glm::ivec2>> bodies; // snek parts, head at the front
+};
+
+// Shorthand for shared_ptr
+typedef std::shared_ptr<SnakeBatch> SnakeBatch_sptr;
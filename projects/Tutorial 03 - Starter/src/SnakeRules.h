@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+
+// The movement rules shared by SnakeSim and SnakeBatch, so a single game and a batch of games always play the same.
+// Directions are 0 up, 1 down, 2 left, 3 right. Everything here is branch free integer math, so the compiler can
+// vectorize loops that apply it to whole arrays of games at once
+namespace SnakeRules {
+	// reward for dying, fruit rewards are the points they are worth
+	constexpr float DEATH_REWARD = -1.0f;
+
+	// the direction that points straight back the way we came
+	inline int32_t opposite(int32_t direction) {
+		return direction ^ 1;
+	}
+
+	// the direction to move in this tick. input is the requested direction, or -1 to keep going straight. turning back
+	// onto the snake's own body is ignored
+	inline int32_t steer(int32_t direction, int32_t input) {
+		bool valid = (input >= 0) & (input < 4) & (input != opposite(direction));
+		return valid ? input : direction;
+	}
+
+	// how far one step in the given direction moves along x and y
+	inline int32_t stepX(int32_t direction) {
+		return (int32_t)(direction == 3) - (int32_t)(direction == 2);
+	}
+	inline int32_t stepY(int32_t direction) {
+		return (int32_t)(direction == 0) - (int32_t)(direction == 1);
+	}
+
+	// wrap a coordinate that is at most one step off the board back onto the other side
+	inline int32_t wrap(int32_t value, int32_t size) {
+		return value + (int32_t)(value < 0) * size - (int32_t)(value >= size) * size;
+	}
+}
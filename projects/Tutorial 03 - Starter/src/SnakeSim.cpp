@@ -0,0 +1,270 @@
+#include "SnakeSim.h"
+#include "SnakeRules.h"
+#include "Snapshot.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace {
+	// Boards up to this many cells have all of their storage sized for a completely full board up front. Bigger
+	// boards start here and grow as the game does, a 4096x4096 board would otherwise reserve hundreds of megabytes
+	// for a snake that never gets that long
+	const size_t RESERVED_CELLS = 4096;
+
+	size_t reservedCells(int width, int height) {
+		return std::min((size_t)width * height, RESERVED_CELLS);
+	}
+}
+
+SnakeSim::SnakeSim(uint64_t seed, int width, int height) :
+	grid((checkSize(width, height), width), height), // checked before the grid sizes anything off of it
+	rng(seed),
+	snek(reservedCells(width, height))
+{
+	// the storage is only ever rewound by resetGame, so once it has grown to fit a game stepping the sim never has to
+	// go to the heap. On a board up to RESERVED_CELLS that is from the very first tick
+	grid.reserve((uint32_t)reservedCells(width, height));
+	dead.reserve(reservedCells(width, height));
+
+	resetGame();
+}
+
+SnakeSim::~SnakeSim() { }
+
+StepResult SnakeSim::step(int input) {
+	StepResult result;
+
+	// steer the snake, unless that would turn it back on itself
+	direction = SnakeRules::steer(direction, input);
+
+	glm::ivec2 head = grid.wrap(snek[0] + glm::ivec2(SnakeRules::stepX(direction), SnakeRules::stepY(direction)));
+
+	// the tail moves out of its cell first, so the head is allowed to follow right behind it
+	if (growth > 0) {
+		growth--;
+	}
+	else {
+		grid.set(snek.back(), CellType::Empty);
+		snek.popBack();
+	}
+
+	tickCount++;
+
+	// everything we could run into is a single lookup in the grid
+	switch (grid.get(head)) {
+	case CellType::Snake: // die if collidiing with self
+	case CellType::Obstacle: // or with an obstacle
+		resetGame();
+		result.died = true;
+		return result;
+
+	case CellType::Fruit: // add length to snek and score, 1 for a fruit and 2 for a big fruit
+		growth += whichFruit;
+		score += whichFruit;
+		result.scoreGained = whichFruit;
+		break;
+
+	default:
+		break;
+	}
+
+	snek.pushFront(head);
+	grid.set(head, CellType::Snake);
+
+	if (result.scoreGained > 0) {
+		whichFruit = rng.below(2) + 1; // set which fruit to spawn
+
+		// gen new fruit pos, if there is nowhere left to put it the snake has filled the board
+		if (!newFruitPos()) {
+			resetGame();
+			result.won = true;
+			return result;
+		}
+	}
+
+	obTicks++;
+
+	if (obTicks >= OBSTACLE_TICKS) {
+		addObstacle();
+		obTicks = 0;
+	}
+
+	return result;
+}
+
+void SnakeSim::resetGame()
+{
+	grid.clear();
+
+	// start with a single snek part in the middle of the board, heading up
+	snek.clear();
+	snek.pushFront(glm::ivec2(grid.getWidth() / 2, grid.getHeight() / 2));
+	grid.set(snek[0], CellType::Snake);
+	direction = 0;
+	growth = 0;
+
+	dead.clear(); // clear obstacle vector
+	addObstacle();
+
+	whichFruit = 1;
+	newFruitPos(); // gen random fruit pos
+
+	this->score = 0; // reset score
+	this->tickCount = 0; // reset the tick counters
+	this->obTicks = 0;
+}
+
+void SnakeSim::reset(uint64_t seed)
+{
+	rng = Random(seed);
+	resetGame();
+}
+
+void SnakeSim::reset(uint64_t seed, int width, int height)
+{
+	if (width != grid.getWidth() || height != grid.getHeight()) {
+		checkSize(width, height);
+		grid = Grid(width, height);
+		grid.reserve((uint32_t)reservedCells(width, height));
+		dead.reserve(reservedCells(width, height));
+	}
+	reset(seed);
+}
+
+void SnakeSim::checkSize(int width, int height)
+{
+	if (width <= 0 || height <= 0 || (uint64_t)width * height < MIN_CELLS || (uint64_t)width * height > MAX_CELLS) {
+		throw std::runtime_error("Board size " + std::to_string(width) + "x" + std::to_string(height) + " is out of range");
+	}
+}
+
+void SnakeSim::addObstacle()
+{
+	glm::ivec2 cell;
+	if (randomEmptyCell(cell)) {
+		dead.push_back(cell);
+		grid.set(cell, CellType::Obstacle);
+	}
+}
+
+bool SnakeSim::newFruitPos()
+{
+	if (!randomEmptyCell(fruit)) {
+		return false;
+	}
+
+	grid.set(fruit, CellType::Fruit);
+	return true;
+}
+
+bool SnakeSim::randomEmptyCell(glm::ivec2& cell)
+{
+	// the grid keeps a list of every empty cell, so one draw always lands somewhere that isn't in the snake body or on
+	// an obstacle/fruit, no matter how full the board is
+	uint32_t emptyCount = grid.getEmptyCount();
+	if (emptyCount == 0) {
+		return false;
+	}
+
+	cell = grid.getEmptyCell(rng.below(emptyCount));
+	return true;
+}
+
+uint64_t SnakeSim::getChecksum() const
+{
+	// FNV-1a over the board and everything that isn't visible on it
+	uint64_t hash = 14695981039346656037ull;
+	auto mix = [&hash](uint64_t value) {
+		hash = (hash ^ value) * 1099511628211ull;
+	};
+
+	for (int y = 0; y < grid.getHeight(); y++) {
+		for (int x = 0; x < grid.getWidth(); x++) {
+			mix((uint64_t)grid.get(glm::ivec2(x, y)));
+		}
+	}
+	for (size_t i = 0; i < snek.size(); i++) {
+		mix((uint64_t)(uint32_t)snek[i].x << 32 | (uint32_t)snek[i].y);
+	}
+
+	mix(rng.state);
+	mix((uint64_t)direction);
+	mix((uint64_t)growth);
+	mix(tickCount);
+	mix(obTicks);
+	mix((uint64_t)whichFruit);
+	mix((uint64_t)score);
+
+	return hash;
+}
+
+void SnakeSim::saveSnapshot(SimSnapshot& snapshot) const
+{
+	// the cells themselves aren't saved, they all follow from the snek, obstacles and fruit
+	snapshot.width = grid.getWidth();
+	snapshot.height = grid.getHeight();
+	grid.saveFreeOrder(snapshot.orderSlots, snapshot.orderCells);
+	snapshot.emptyCount = grid.getEmptyCount();
+
+	snapshot.snek.resize(snek.size());
+	for (size_t i = 0; i < snek.size(); i++) {
+		snapshot.snek[i] = snek[i];
+	}
+	snapshot.dead.assign(dead.begin(), dead.end());
+
+	snapshot.scalars.rngState = rng.state;
+	snapshot.scalars.fruit = fruit;
+	snapshot.scalars.direction = direction;
+	snapshot.scalars.growth = growth;
+	snapshot.scalars.tickCount = tickCount;
+	snapshot.scalars.obTicks = obTicks;
+	snapshot.scalars.whichFruit = whichFruit;
+	snapshot.scalars.score = score;
+}
+
+void SnakeSim::restoreSnapshot(const SimSnapshot& snapshot)
+{
+	if (snapshot.width != grid.getWidth() || snapshot.height != grid.getHeight() || snapshot.snek.empty()) {
+		throw std::runtime_error("Snapshot doesn't fit this board");
+	}
+
+	// a snapshot can come from a file, so every cell is checked before anything is written to the grid
+	auto onBoard = [&snapshot](glm::ivec2 cell) {
+		return cell.x >= 0 && cell.y >= 0 && cell.x < snapshot.width && cell.y < snapshot.height;
+	};
+	bool fits = onBoard(snapshot.scalars.fruit);
+	for (glm::ivec2 cell : snapshot.dead) {
+		fits = fits && onBoard(cell);
+	}
+	for (glm::ivec2 cell : snapshot.snek) {
+		fits = fits && onBoard(cell);
+	}
+	if (!fits) {
+		throw std::runtime_error("Snapshot has cells off the board");
+	}
+
+	// the empty cell index already has every taken cell as taken, so filling the cells back in leaves it alone
+	grid.restore(snapshot.orderSlots, snapshot.orderCells, snapshot.emptyCount);
+	grid.set(snapshot.scalars.fruit, CellType::Fruit);
+	for (glm::ivec2 cell : snapshot.dead) {
+		grid.set(cell, CellType::Obstacle);
+	}
+
+	// push from the tail forwards, so the head ends up at the front
+	snek.clear();
+	for (size_t i = snapshot.snek.size(); i > 0; i--) {
+		snek.pushFront(snapshot.snek[i - 1]);
+		grid.set(snapshot.snek[i - 1], CellType::Snake);
+	}
+	dead.assign(snapshot.dead.begin(), snapshot.dead.end());
+
+	rng.state = snapshot.scalars.rngState;
+	fruit = snapshot.scalars.fruit;
+	direction = snapshot.scalars.direction;
+	growth = snapshot.scalars.growth;
+	tickCount = snapshot.scalars.tickCount;
+	obTicks = snapshot.scalars.obTicks;
+	whichFruit = snapshot.scalars.whichFruit;
+	score = snapshot.scalars.score;
+}
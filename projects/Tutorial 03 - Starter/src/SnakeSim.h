@@ -0,0 +1,92 @@
+#pragma once
+
+#include <GLM/glm.hpp>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "Grid.h"
+#include "RingBuffer.h"
+#include "Random.h"
+
+struct SimSnapshot;
+
+// What happened during a single tick of the simulation
+struct StepResult {
+	int scoreGained = 0; // points earned this tick (1 for a fruit, 2 for a big fruit)
+	bool died = false; // true if the snake hit itself or an obstacle. The sim has already been reset when this is set
+	bool won = false; // true if the snake filled the board, so there was nowhere left for the fruit. The sim has been reset
+};
+
+// All of the rules of the game, with no dependency on GLFW, GL or wall clock time. The sim only moves forward when
+// step() is called, so it can be driven by the game loop, by a bot, or as fast as possible on a headless machine.
+// Every entity is stored by value in storage that grows with the game and is reused wholesale by resetGame. The board
+// can be any size, resetting and snapshotting only cost as much as what has happened on it since the last reset
+class SnakeSim {
+public:
+	// Length of one tick in seconds when the sim is played in real time
+	static constexpr double TICK_SECONDS = 0.1;
+	// Number of ticks between new obstacles being spawned (10 seconds of real time)
+	static constexpr uint32_t OBSTACLE_TICKS = 100;
+	// Width and height of the board in cells, unless the sim is given a size
+	static constexpr int DEFAULT_SIZE = 39;
+	// The board has to fit the starting snake, an obstacle and a fruit, and every cell index has to fit in 32 bits
+	static constexpr int MIN_CELLS = 4;
+	static constexpr uint64_t MAX_CELLS = 0xFFFFFFFFull;
+
+	// sets up the starting snake, fruit and first obstacle. The seed decides every spawn. Throws if the board is too
+	// small or too big (see MIN_CELLS and MAX_CELLS)
+	SnakeSim(uint64_t seed = 0, int width = DEFAULT_SIZE, int height = DEFAULT_SIZE);
+	~SnakeSim();
+
+	// advance the game by one tick. input is the direction the player wants to go in (0 up, 1 down, 2 left, 3 right),
+	// or -1 to keep going straight. turning back onto the snake's own body is ignored
+	StepResult step(int input);
+
+	void resetGame(); // called upon death (run into yourself or an obstacle), rewinds all storage without freeing it
+	void reset(uint64_t seed); // starts a brand new game from the given seed, reusing all of the storage
+	void reset(uint64_t seed, int width, int height); // starts a brand new game on a board of a different size, throws like the constructor
+
+	const Grid& getGrid() const { return grid; } // what is in every cell of the board
+	const RingBuffer<glm::ivec2>& getSnek() const { return snek; } // cells of the snek, head at i = 0
+	const std::vector<glm::ivec2>& getDead() const { return dead; } // cells of the obstacles
+	glm::ivec2 getFruit() const { return fruit; } // cell of the fruit that can currently be eaten
+	int getWhichFruit() const { return whichFruit; } // 1 reg fruit, 2 big fruit
+	int getDirection() const { return direction; } // direction the snake moved in last tick
+	int getScore() const { return score; } // player score
+	uint64_t getTickCount() const { return tickCount; } // ticks since the last reset
+	int getWidth() const { return grid.getWidth(); } // board size in cells
+	int getHeight() const { return grid.getHeight(); }
+
+	// hash of the whole game state, two sims that agree on this have played out the same way. This visits every cell
+	// of the board, so it is meant for the end of a replay rather than every tick
+	uint64_t getChecksum() const;
+
+	static void checkSize(int width, int height); // throws if a board of this size can't be played on
+
+	void saveSnapshot(SimSnapshot& snapshot) const; // copy out the complete state of the game, reusing snapshot's storage
+	void restoreSnapshot(const SimSnapshot& snapshot); // put the game back exactly how it was, throws if the board size differs
+
+protected:
+	void addObstacle(); // place a new obstacle on a random empty cell, if there are any left
+	bool newFruitPos(); // move the fruit to a random empty cell, returns false if the board is full
+	bool randomEmptyCell(glm::ivec2& cell); // pick a random cell that nothing is sitting in, returns false if the board is full
+
+private:
+	Grid grid; // what is in each cell, updated incrementally as the snek moves
+	Random rng; // decides where fruit and obstacles spawn, and which fruit comes next
+
+	RingBuffer<glm::ivec2> snek; // cells of the snek parts, head at i = 0. moving pushes a new head and pops the tail
+	std::vector<glm::ivec2> dead; // green, resets game and score when collided with
+	glm::ivec2 fruit; // red fruit increases score by 1, yellow big fruit by 2
+
+	int direction = 0; // direction of the head, 0 up, 1 down, 2 left, 3 right
+	int growth = 0; // how many more ticks the tail should stay put for after eating
+	uint64_t tickCount = 0; // amount of times step has been called since the last reset
+	uint32_t obTicks = 0; // ticks since the last obstacle was spawned
+	int whichFruit = 1; //1 reg fruit, 2 big fruit
+	int score = 0; // player score
+};
+
+// Shorthand for shared_ptr
+typedef std::shared_ptr<SnakeSim> SnakeSim_sptr;
@@ -0,0 +1,160 @@
+#include "SnakeWorld.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace {
+	const glm::vec4 SNAKE_COLOUR = glm::vec4(0, 0, 1, 1); // blue
+	const glm::vec4 OBSTACLE_COLOUR = glm::vec4(0, 1, 0, 1); // green
+	const glm::vec4 FRUIT_COLOUR = glm::vec4(1, 0, 0, 1); // red
+	const glm::vec4 BIG_FRUIT_COLOUR = glm::vec4(1, 1, 0, 1); // yellow
+	const glm::vec4 SCORE_COLOUR = glm::vec4(1, 1, 1, 1); // white
+
+	const glm::vec2 SCORE_START = glm::vec2(-0.95f, 0.95f); // where the first score dot goes on screen
+	const float SCORE_SIZE = 0.025f;
+	const float SCORE_SPACING = 0.0125f + 0.05f;
+}
+
+void SnakeWorld::rebuild(const SnakeSim& sim)
+{
+	registry.reset();
+	obstacleCount = 0;
+
+	// fit the longer side of the board to the screen, centred on the middle cell like the snake starts in
+	cellSize = BOARD_EXTENT / std::max(sim.getWidth(), sim.getHeight());
+	center = glm::vec2(sim.getWidth() / 2, sim.getHeight() / 2);
+
+	// from the head back, so every segment can point at the one in front of it
+	const RingBuffer<glm::ivec2>& snek = sim.getSnek();
+	head = tail = __CreateSegment(snek[0], entt::null);
+	for (size_t i = 1; i < snek.size(); i++) {
+		tail = __CreateSegment(snek[i], tail);
+	}
+
+	tailCover = registry.create();
+	registry.assign<GridPos>(tailCover, snek.back());
+	registry.assign<Renderable>(tailCover, SNAKE_COLOUR, cellSize);
+
+	fruit = registry.create();
+	registry.assign<GridPos>(fruit, sim.getFruit());
+	registry.assign<Renderable>(fruit, FRUIT_COLOUR, cellSize);
+
+	__SpawnObstacles(sim);
+	__SyncFruit(sim);
+	__SyncScore(sim);
+}
+
+void SnakeWorld::onStep(const SnakeSim& sim, const StepResult& result)
+{
+	// after a death or a win the sim starts a whole new game, nothing carries over
+	if (result.died || result.won) {
+		rebuild(sim);
+		return;
+	}
+
+	__MoveSnake(sim);
+	__SpawnObstacles(sim);
+	__SyncFruit(sim);
+	__SyncScore(sim);
+}
+
+void SnakeWorld::__MoveSnake(const SnakeSim& sim)
+{
+	const RingBuffer<glm::ivec2>& snek = sim.getSnek();
+
+	entt::entity oldHead = head;
+	glm::ivec2 prevHead = registry.get<GridPos>(oldHead).cell;
+	glm::ivec2 prevTail = registry.get<GridPos>(tail).cell;
+
+	// the sim grows by at most one cell a tick. If it didn't grow, the tail left its cell and can be the new head
+	if (snek.size() > registry.size<BodySegment>()) {
+		head = __CreateSegment(snek.front(), entt::null);
+	}
+	else {
+		head = tail;
+		entt::entity next = registry.get<BodySegment>(tail).next;
+		tail = next != entt::null ? next : head; // a snake one segment long is its own tail
+		registry.get<GridPos>(head).cell = snek.front();
+		registry.get<BodySegment>(head).next = entt::null;
+	}
+	if (oldHead != head) {
+		registry.get<BodySegment>(oldHead).next = head;
+	}
+
+	// only the head slides
+	registry.reset<Slide>(oldHead);
+	registry.assign_or_replace<Slide>(head, prevHead);
+
+	registry.get<GridPos>(tailCover).cell = snek.back();
+	registry.assign_or_replace<Slide>(tailCover, prevTail);
+}
+
+void SnakeWorld::__SpawnObstacles(const SnakeSim& sim)
+{
+	const std::vector<glm::ivec2>& dead = sim.getDead();
+	for (; obstacleCount < dead.size(); obstacleCount++) {
+		entt::entity obstacle = registry.create();
+		registry.assign<GridPos>(obstacle, dead[obstacleCount]);
+		registry.assign<Renderable>(obstacle, OBSTACLE_COLOUR, cellSize);
+	}
+}
+
+void SnakeWorld::__SyncFruit(const SnakeSim& sim)
+{
+	registry.get<GridPos>(fruit).cell = sim.getFruit();
+	registry.get<Renderable>(fruit).colour = sim.getWhichFruit() == 1 ? FRUIT_COLOUR : BIG_FRUIT_COLOUR;
+}
+
+void SnakeWorld::__SyncScore(const SnakeSim& sim)
+{
+	// the score only drops when a game is rewound or loaded, start the row over
+	size_t dots = registry.size<ScreenPos>();
+	if (dots > (size_t)sim.getScore()) {
+		auto view = registry.view<ScreenPos>();
+		registry.destroy(view.begin(), view.end());
+		dots = 0;
+	}
+
+	for (; dots < (size_t)sim.getScore(); dots++) {
+		entt::entity dot = registry.create();
+		registry.assign<ScreenPos>(dot, SCORE_START + glm::vec2(dots * SCORE_SPACING, 0.0f));
+		registry.assign<Renderable>(dot, SCORE_COLOUR, SCORE_SIZE);
+	}
+}
+
+entt::entity SnakeWorld::__CreateSegment(glm::ivec2 cell, entt::entity next)
+{
+	entt::entity segment = registry.create();
+	registry.assign<GridPos>(segment, cell);
+	registry.assign<BodySegment>(segment, next);
+	registry.assign<Renderable>(segment, SNAKE_COLOUR, cellSize);
+	return segment;
+}
+
+void SnakeWorld::buildBatch(QuadRenderer& renderer, float alpha) const
+{
+	registry.view<const GridPos, const Renderable>().each([&](entt::entity entity, const GridPos& pos, const Renderable& renderable) {
+		glm::vec2 cell = glm::vec2(pos.cell);
+
+		// slide over from the last cell, unless that was across the edge of the board, which would drag the square
+		// across the whole screen
+		if (const Slide* slide = registry.try_get<Slide>(entity)) {
+			glm::ivec2 delta = pos.cell - slide->from;
+			if (abs(delta.x) <= 1 && abs(delta.y) <= 1) {
+				cell = glm::mix(glm::vec2(slide->from), cell, alpha);
+			}
+		}
+
+		QuadInstance& instance = renderer.Push();
+		instance.Position = (cell - center) * cellSize;
+		instance.Size = glm::vec2(renderable.size);
+		instance.Color = renderable.colour;
+	});
+
+	registry.view<const ScreenPos, const Renderable>().each([&](const ScreenPos& pos, const Renderable& renderable) {
+		QuadInstance& instance = renderer.Push();
+		instance.Position = pos.position;
+		instance.Size = glm::vec2(renderable.size);
+		instance.Color = renderable.colour;
+	});
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <entt.hpp>
+#include <memory>
+
+#include "Components.h"
+#include "QuadRenderer.h"
+#include "SnakeSim.h"
+
+// Every entity the game draws, stored as components in an EnTT registry so each kind sits in its own contiguous pool.
+// The sim is the one source of truth for the rules (movement, collisions, which are a single grid lookup there, and
+// spawning), since the headless runs, replays and checkpoints all play it without a world. The systems in here catch
+// the entities up with it after every tick: the snake's movement, newly spawned obstacles, the fruit and the score.
+// Building the render batch is then one pass over everything with a position and a Renderable
+class SnakeWorld {
+public:
+	// How much of the screen the longer side of the board covers, in NDC. The middle cell of the board sits at the
+	// center of the screen, and everything is scaled to fit, a 39x39 board has cells 0.05 wide
+	static constexpr float BOARD_EXTENT = 1.95f;
+
+	void rebuild(const SnakeSim& sim); // throw every entity away and recreate them from the sim, after a reset, rewind or load
+	void onStep(const SnakeSim& sim, const StepResult& result); // catch the entities up with a tick the sim just took
+
+	// add a square for every Renderable to the batch. alpha is how far we are towards the next tick (0 - 1), entities
+	// that moved last tick are drawn that far along from where they came from
+	void buildBatch(QuadRenderer& renderer, float alpha) const;
+
+	float getCellSize() const { return cellSize; } // width of a cell on screen, for the last board that was rebuilt from
+
+	entt::registry& getRegistry() { return registry; }
+	const entt::registry& getRegistry() const { return registry; }
+
+private:
+	// systems, each one brings one kind of entity in line with the sim
+	void __MoveSnake(const SnakeSim& sim); // the tail entity is reused as the new head, unless the snake grew
+	void __SpawnObstacles(const SnakeSim& sim); // creates entities for obstacles the sim has added since the last call
+	void __SyncFruit(const SnakeSim& sim); // moves the fruit and updates its colour
+	void __SyncScore(const SnakeSim& sim); // adds a score dot for every point, or clears them if the score went down
+
+	entt::entity __CreateSegment(glm::ivec2 cell, entt::entity next);
+
+	entt::registry registry;
+
+	// the ends of the snake, the segments in between are found through BodySegment::next
+	entt::entity head = entt::null;
+	entt::entity tail = entt::null;
+	entt::entity tailCover = entt::null; // extra square that slides out of the cell the tail just left
+	entt::entity fruit = entt::null;
+	size_t obstacleCount = 0; // number of the sim's obstacles that have an entity
+
+	// where the board is on screen, worked out from its size when rebuilding
+	float cellSize = BOARD_EXTENT / SnakeSim::DEFAULT_SIZE;
+	glm::vec2 center = glm::vec2(SnakeSim::DEFAULT_SIZE / 2);
+};
+
+// Shorthand for shared_ptr
+typedef std::shared_ptr<SnakeWorld> SnakeWorld_sptr;
@@ -0,0 +1,98 @@
+#include "Snapshot.h"
+
+#include <algorithm>
+
+void SimDelta::diff(const SimSnapshot& base, const SimSnapshot& current)
+{
+	// freeing or filling a cell only swaps two slots, so the order changes in about as many places as the cells do.
+	// Both lists are sorted by slot, so walk them together. A slot that only base has went back to its own cell
+	changedSlots.clear();
+	slotValues.clear();
+	size_t b = 0, c = 0;
+	while (b < base.orderSlots.size() || c < current.orderSlots.size()) {
+		uint32_t baseSlot = b < base.orderSlots.size() ? base.orderSlots[b] : UINT32_MAX;
+		uint32_t currentSlot = c < current.orderSlots.size() ? current.orderSlots[c] : UINT32_MAX;
+
+		if (currentSlot < baseSlot) {
+			changedSlots.push_back(currentSlot);
+			slotValues.push_back(current.orderCells[c++]);
+		}
+		else if (baseSlot < currentSlot) {
+			changedSlots.push_back(baseSlot);
+			slotValues.push_back(baseSlot);
+			b++;
+		}
+		else {
+			if (current.orderCells[c] != base.orderCells[b]) {
+				changedSlots.push_back(currentSlot);
+				slotValues.push_back(current.orderCells[c]);
+			}
+			b++;
+			c++;
+		}
+	}
+	emptyCount = current.emptyCount;
+
+	// the head moves one cell a tick, so if we are still in the same game the body is the heads from the ticks since
+	// followed by what is left of the base body. If that doesn't line up the snake has died since, keep it whole
+	size_t pushed = current.snek.size();
+	if (current.scalars.tickCount >= base.scalars.tickCount) {
+		uint64_t ticks = current.scalars.tickCount - base.scalars.tickCount;
+		if (ticks <= current.snek.size() && current.snek.size() - ticks <= base.snek.size() &&
+			std::equal(current.snek.begin() + ticks, current.snek.end(), base.snek.begin())) {
+			pushed = (size_t)ticks;
+		}
+	}
+	newHeads.assign(current.snek.begin(), current.snek.begin() + pushed);
+	keptBody = (uint32_t)(current.snek.size() - pushed);
+
+	// obstacles are only ever added to the end until the next death
+	keptDead = 0;
+	if (current.dead.size() >= base.dead.size() && std::equal(base.dead.begin(), base.dead.end(), current.dead.begin())) {
+		keptDead = (uint32_t)base.dead.size();
+	}
+	newDead.assign(current.dead.begin() + keptDead, current.dead.end());
+
+	scalars = current.scalars;
+}
+
+void SimDelta::apply(SimSnapshot& state) const
+{
+	// merge the changes into the base's sorted slots, leaving out any slot that is back to holding its own cell
+	std::vector<uint32_t> slots, cells;
+	slots.reserve(state.orderSlots.size() + changedSlots.size());
+	cells.reserve(state.orderSlots.size() + changedSlots.size());
+
+	size_t b = 0, c = 0;
+	while (b < state.orderSlots.size() || c < changedSlots.size()) {
+		uint32_t baseSlot = b < state.orderSlots.size() ? state.orderSlots[b] : UINT32_MAX;
+		uint32_t changedSlot = c < changedSlots.size() ? changedSlots[c] : UINT32_MAX;
+
+		uint32_t slot, cell;
+		if (changedSlot <= baseSlot) {
+			slot = changedSlot;
+			cell = slotValues[c++];
+			b += baseSlot == changedSlot;
+		}
+		else {
+			slot = baseSlot;
+			cell = state.orderCells[b++];
+		}
+
+		if (cell != slot) {
+			slots.push_back(slot);
+			cells.push_back(cell);
+		}
+	}
+	state.orderSlots.swap(slots);
+	state.orderCells.swap(cells);
+	state.emptyCount = emptyCount;
+
+	state.snek.resize(keptBody);
+	state.snek.insert(state.snek.begin(), newHeads.begin(), newHeads.end());
+
+	state.dead.resize(keptDead);
+	state.dead.insert(state.dead.end(), newDead.begin(), newDead.end());
+
+	state.scalars = scalars;
+}
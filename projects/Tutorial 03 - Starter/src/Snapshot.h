@@ -0,0 +1,67 @@
+#pragma once
+
+#include <GLM/glm.hpp>
+#include <cstdint>
+#include <vector>
+#include <cereal/cereal.hpp>
+#include <cereal/types/vector.hpp>
+
+#include "CerealGLM.h"
+#include "Grid.h"
+
+// The parts of a sim that are a handful of numbers rather than something the size of the board
+struct SimScalars {
+	uint64_t rngState = 0; // the rng's state, so spawns carry on exactly where they left off
+	glm::ivec2 fruit = glm::ivec2(0);
+	int direction = 0;
+	int growth = 0;
+	uint64_t tickCount = 0;
+	uint32_t obTicks = 0;
+	int whichFruit = 1;
+	int score = 0;
+
+	template<class Archive> void serialize(Archive& archive) {
+		archive(rngState, fruit, direction, growth, tickCount, obTicks, whichFruit, score);
+	}
+};
+
+// Everything needed to put a SnakeSim back exactly how it was, filled in by SnakeSim::saveSnapshot. The cells aren't
+// stored, since they all follow from the snek, obstacles and fruit, but the order of the empty cell index is, since it
+// decides which cell the next random spawn lands on. Only the slots of it that have moved are kept (see
+// FreeCellSet::save), so a snapshot is about the size of what is on the board rather than the board itself. The
+// vectors are reused from one save to the next, so snapshotting a running game stops allocating once they are big enough
+struct SimSnapshot {
+	int width = 0, height = 0; // board size in cells
+	std::vector<uint32_t> orderSlots; // slots of the empty cell index that don't hold their own cell, ascending
+	std::vector<uint32_t> orderCells; // the cell in each of those slots
+	uint32_t emptyCount = 0; // number of empty cells at the front of the index
+	std::vector<glm::ivec2> snek; // head first
+	std::vector<glm::ivec2> dead; // obstacles, in the order they were spawned
+	SimScalars scalars;
+
+	template<class Archive> void serialize(Archive& archive) {
+		archive(width, height, orderSlots, orderCells, emptyCount, snek, dead, scalars);
+	}
+};
+
+// The difference between two snapshots of the same sim. Only the empty cell slots that changed are kept, a slot that
+// went back to holding its own cell is stored as holding it. The body is kept as the heads pushed since the base and
+// how much of the base body is still behind them, and the obstacles as the ones spawned since. After a death nothing
+// of the old body is left, so the new one is kept whole
+struct SimDelta {
+	std::vector<uint32_t> changedSlots; // slots of the empty cell index that changed, ascending
+	std::vector<uint32_t> slotValues; // the cell in each of those slots now
+	uint32_t emptyCount = 0;
+	std::vector<glm::ivec2> newHeads; // cells pushed onto the front of the body since the base, head first
+	uint32_t keptBody = 0; // how many cells from the front of the base body follow the new heads
+	std::vector<glm::ivec2> newDead; // obstacles spawned since the base
+	uint32_t keptDead = 0; // how many of the base obstacles are still there
+	SimScalars scalars;
+
+	void diff(const SimSnapshot& base, const SimSnapshot& current); // store the changes that turn base into current
+	void apply(SimSnapshot& state) const; // turn the base snapshot this was diffed against into the current one
+
+	template<class Archive> void serialize(Archive& archive) {
+		archive(changedSlots, slotValues, emptyCount, newHeads, keptBody, newDead, keptDead, scalars);
+	}
+};
@@ -1,21 +1,136 @@
 #include "Game.h"
+#include "Headless.h"
 #include "Logging.h"
+#include "Profiler.h"
 
-#define _CRTDBG_MAP_ALLOC
+#include <stdexcept>
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+
+// The debug heap (and its leak check on exit) only exists in the MSVC runtime
+#ifdef _MSC_VER
+#define _CRTDBG_MAP_ALLOC
 #include <crtdbg.h>
+#endif
 
-int main() {
+int main(int argc, char** argv) {
 
+#ifdef _MSC_VER
 	_CrtSetDbgFlag(_CRTDBG_ALLOC_MEM_DF | _CRTDBG_LEAK_CHECK_DF);
 	long long memBreak = 0;
 	if (memBreak) _CrtSetBreakAlloc(memBreak);
+#endif
 
 	{
 		Logger::Init();
 
+		// --fast-forward <replay>... checks stored games headless, and exits with the number that failed
+		if (argc > 1 && strcmp(argv[1], "--fast-forward") == 0) {
+			int failed = FastForward(argc - 2, argv + 2);
+			Logger::Uninitialize();
+			return failed;
+		}
+
 		Game* game = new Game();
-		game->Run();
+
+		// a bad --board or a --replay that won't load throws, which is reported the same way as in the headless build
+		try {
+			// the offscreen options are collected first, since several of them go into one call
+			bool offscreen = false;
+			uint64_t offscreenFrames = 0;
+			int offscreenWidth = 800, offscreenHeight = 800;
+			Game::ContextApi contextApi = Game::ContextApi::Native;
+			const char* captureDirectory = nullptr;
+			int captureEvery = 1;
+			// the replay is loaded after every other option, so its seed and board win over --seed and --board
+			const char* replayPath = nullptr;
+
+			for (int i = 1; i + 1 < argc; i++) {
+				// --seed <number> replays the same fruit and obstacle spawns as an earlier run
+				if (strcmp(argv[i], "--seed") == 0) {
+					game->SetSeed(strtoull(argv[i + 1], nullptr, 10));
+				}
+				// --board <width>x<height> plays on a board of a different size, 39x39 by default
+				else if (strcmp(argv[i], "--board") == 0) {
+					int width = 0, height = 0;
+					sscanf(argv[i + 1], "%dx%d", &width, &height);
+					game->SetBoardSize(width, height);
+				}
+				// --record <path> picks where the session is saved, last.replay by default
+				else if (strcmp(argv[i], "--record") == 0) {
+					game->SetReplayPath(argv[i + 1]);
+				}
+				// --replay <path> watches a recorded session in real time
+				else if (strcmp(argv[i], "--replay") == 0) {
+					replayPath = argv[i + 1];
+				}
+				// --tick-rate <ticks per second> changes how fast the snake moves, 10 by default
+				else if (strcmp(argv[i], "--tick-rate") == 0) {
+					game->SetTickRate(strtod(argv[i + 1], nullptr));
+				}
+				// --max-catch-up <ticks> is how many ticks one slow frame may catch up on before the rest are dropped
+				else if (strcmp(argv[i], "--max-catch-up") == 0) {
+					game->SetMaxCatchUpSteps(atoi(argv[i + 1]));
+				}
+				// --frame-cap <fps> sleeps off the rest of each frame instead of waiting for vsync, 0 doesn't limit frames at all
+				else if (strcmp(argv[i], "--frame-cap") == 0) {
+					double frameCap = strtod(argv[i + 1], nullptr);
+					game->SetFrameMode(frameCap > 0.0 ? Game::FrameMode::Capped : Game::FrameMode::Uncapped, frameCap);
+				}
+				// --profile-interval <seconds> sets how often the profiler logs a summary, 0 turns it off
+				else if (strcmp(argv[i], "--profile-interval") == 0) {
+					Profiler::SetExportInterval(strtod(argv[i + 1], nullptr));
+				}
+				// --offscreen <frames> renders into a hidden framebuffer, and closes after that many frames (0 closes
+				// when the --replay finishes)
+				else if (strcmp(argv[i], "--offscreen") == 0) {
+					offscreen = true;
+					offscreenFrames = strtoull(argv[i + 1], nullptr, 10);
+				}
+				// --offscreen-size <width>x<height> is 800x800 by default
+				else if (strcmp(argv[i], "--offscreen-size") == 0) {
+					sscanf(argv[i + 1], "%dx%d", &offscreenWidth, &offscreenHeight);
+				}
+				// --context-api <egl|osmesa> picks how the offscreen context is created, for software GL without a GPU
+				else if (strcmp(argv[i], "--context-api") == 0) {
+					if (strcmp(argv[i + 1], "egl") == 0) {
+						contextApi = Game::ContextApi::Egl;
+					}
+					else if (strcmp(argv[i + 1], "osmesa") == 0) {
+						contextApi = Game::ContextApi::OsMesa;
+					}
+				}
+				// --capture <directory> saves the offscreen frames as PNGs
+				else if (strcmp(argv[i], "--capture") == 0) {
+					captureDirectory = argv[i + 1];
+				}
+				// --capture-every <n> only saves every Nth frame
+				else if (strcmp(argv[i], "--capture-every") == 0) {
+					captureEvery = atoi(argv[i + 1]);
+				}
+			}
+
+			if (replayPath != nullptr) {
+				game->PlayReplay(replayPath);
+			}
+
+			if (offscreen) {
+				game->SetOffscreen(offscreenWidth, offscreenHeight, offscreenFrames, contextApi);
+				if (captureDirectory != nullptr) {
+					game->SetCapture(captureDirectory, captureEvery);
+				}
+			}
+
+			game->Run();
+		}
+		catch (const std::exception& e) {
+			LOG_ERROR(e.what());
+			delete game;
+			Logger::Uninitialize();
+			return 1;
+		}
+
 		delete game;
 
 		Logger::Uninitialize();